@@ -1,4 +1,6 @@
 import pytest 
+import sys
+import warnings
 
 import fill_voids
 import scipy.ndimage
@@ -95,6 +97,23 @@ def test_zero_array():
   fill_voids.fill(labels, in_place=True)
   assert not np.any(labels)
 
+def test_face_row_starts_are_seeded():
+  # (0,0,1) starts a row on both the x = 0 and y = 0 faces
+  # and the rows before it end in background
+  labels = np.ones((5,5,5), dtype=bool, order='F')
+  labels[0,0,1] = False
+  labels[0,4,0] = False
+  labels[4,0,0] = False
+
+  assert np.all(fill_voids.fill(labels) == labels)
+  assert fill_voids.count_voids(labels) == 0
+  assert np.all(fill_voids.fill(np.ascontiguousarray(labels.T)) == labels.T)
+
+  labels = np.ones((5,5), dtype=bool, order='F')
+  labels[0,1] = False
+  labels[4,0] = False
+  assert np.all(fill_voids.fill(labels) == labels)
+
 def test_return_count():
   labels = np.ones((10, 10, 10), dtype=bool)
   labels[3:6,3:6,3:6] = False
@@ -126,3 +145,1019 @@ def test_dimensions(dimension):
     assert False 
   except fill_voids.DimensionError:
     pass
+
+def test_has_holes():
+  labels = np.ones((10, 10, 10), dtype=bool)
+  assert not fill_voids.has_holes(labels)
+
+  labels[3:6,3:6,3:6] = False
+  assert fill_voids.has_holes(labels)
+  assert np.any(labels == False) # input not modified
+
+  labels[3:6,3:6,0] = False
+  assert fill_voids.has_holes(labels[:,:,1:])
+  labels[3:6,3:6,0:3] = False
+  assert not fill_voids.has_holes(labels)
+
+  labels = np.zeros((10,10), dtype=np.float32)
+  assert not fill_voids.has_holes(labels)
+  labels[1:9,1:9] = 1
+  labels[4:8,4:8] = 0
+  assert fill_voids.has_holes(labels)
+  assert not fill_voids.has_holes(labels[..., np.newaxis])
+  assert not fill_voids.has_holes(np.zeros((0,), dtype=np.uint8))
+
+  for segid in SEGIDS[:10]:
+    binimg = np.ascontiguousarray(img == segid)
+    _, N = fill_voids.fill(binimg, return_fill_count=True)
+    assert fill_voids.has_holes(binimg) == (N > 0)
+
+@pytest.mark.parametrize("dtype", DTYPES)
+def test_count_voids(dtype):
+  labels = np.ones((10, 10, 10), dtype=dtype)
+  labels[3:6,3:6,3:6] = 0
+  assert fill_voids.count_voids(labels) == 27
+  assert fill_voids.count_voids(labels[:,:,4]) == 9
+  assert np.count_nonzero(labels == 0) == 27
+
+  for segid in SEGIDS[:10]:
+    binimg = (img == segid).astype(dtype)
+    _, N = fill_voids.fill(binimg, return_fill_count=True)
+    assert fill_voids.count_voids(binimg) == N
+    assert fill_voids.count_voids(np.asfortranarray(binimg)) == N
+
+def test_no_copy_when_nothing_filled():
+  labels = np.zeros((10, 10, 10), dtype=np.uint8, order="F")
+  labels[2:8,2:8,2:8] = 1
+
+  res, N = fill_voids.fill(labels, return_fill_count=True)
+  assert N == 0
+  assert np.shares_memory(res, labels)
+  assert not res.flags.writeable
+  assert np.all(res == labels)
+
+  # non-binary input still needs a 0/1 output
+  labels *= 5
+  res = fill_voids.fill(labels)
+  assert not np.shares_memory(res, labels)
+  assert np.all(res == (labels > 0))
+
+  labels[4,4,4] = 0
+  for arr in (labels, np.ascontiguousarray(labels), labels[:, ::-1, :]):
+    res, N = fill_voids.fill(arr, return_fill_count=True)
+    assert N == 1
+    assert res.shape == arr.shape
+    assert not np.shares_memory(res, labels)
+    assert np.all(res == binary_fill_holes(arr))
+    assert res.flags.writeable
+
+@pytest.mark.parametrize("in_place", [False, True])
+def test_output_modes(in_place):
+  for segid in SEGIDS[:5]:
+    binimg = img == segid
+    filled = binary_fill_holes(binimg)
+
+    holes = fill_voids.fill(np.copy(binimg), in_place=in_place, output="holes")
+    assert holes.dtype == bool
+    assert np.all(holes == (filled & ~binimg))
+
+    exterior, N = fill_voids.fill(np.copy(binimg), in_place=in_place, output="exterior", return_fill_count=True)
+    assert np.all(exterior == ~filled)
+    assert N == np.count_nonzero(filled & ~binimg)
+
+    holes = fill_voids.fill(binimg[:,:,10].astype(np.float32), in_place=in_place, output="holes")
+    assert np.all(holes == (binary_fill_holes(binimg[:,:,10]) & ~binimg[:,:,10]))
+
+  labels = np.ones((10,10,10), dtype=np.uint16)
+  assert not np.any(fill_voids.fill(np.copy(labels), in_place=in_place, output="holes"))
+  assert not np.any(fill_voids.fill(np.copy(labels), in_place=in_place, output="exterior"))
+
+  with pytest.raises(ValueError):
+    fill_voids.fill(labels, output="voids")
+
+@pytest.mark.parametrize("output", ["filled", "holes", "exterior"])
+def test_packed_output(output):
+  def unpack(packed, arr):
+    return np.unpackbits(packed, count=arr.size).reshape(arr.shape, order='F')
+
+  binimg = img == SEGIDS[0]
+  for arr in (
+    binimg, np.asfortranarray(binimg), binimg[::2, 1:, :], 
+    binimg[:,:,20], np.asfortranarray(binimg[:,:,20]),
+    binimg[:,:,20].astype(np.float64), binimg[:,0:7,20].astype(np.uint64),
+  ):
+    expected = fill_voids.fill(arr, output=output)
+    packed, N = fill_voids.fill(arr, output=output, output_format="packed", return_fill_count=True)
+    assert packed.dtype == np.uint8
+    assert packed.shape == ((arr.size + 7) // 8,)
+    assert np.all(unpack(packed, arr) == expected)
+    assert N == fill_voids.count_voids(arr)
+
+@pytest.mark.parametrize("dtype", DTYPES)
+@pytest.mark.parametrize("out_dtype", [bool, np.uint8, np.float32])
+@pytest.mark.parametrize("in_place", [False, True])
+def test_out_dtype(dtype, out_dtype, in_place):
+  binimg = (img == SEGIDS[0]).astype(dtype)
+  orig = np.copy(binimg)
+  expected = binary_fill_holes(binimg)
+
+  res, N = fill_voids.fill(binimg, in_place=in_place, out_dtype=out_dtype, return_fill_count=True)
+  assert res.dtype == out_dtype
+  assert np.all(res == expected)
+  assert N == np.count_nonzero(expected & (orig == 0))
+  if np.dtype(dtype) != np.dtype(out_dtype):
+    assert np.all(binimg == orig)
+
+  res = fill_voids.fill(binimg[:,:,5], in_place=in_place, out_dtype=out_dtype, output="holes")
+  assert res.dtype == out_dtype
+  assert np.all(res == binary_fill_holes(orig[:,:,5]) & (orig[:,:,5] == 0))
+
+@pytest.mark.parametrize("in_place", [False, True])
+def test_fill_value(in_place):
+  seg = np.copy(img[:, :, :], order="F").astype(np.uint32)
+  for segid in SEGIDS[:5]:
+    binimg = seg == segid
+    holes = binary_fill_holes(binimg) & ~binimg
+    expected = np.where(holes, segid, seg)
+
+    seg_cpy = np.copy(seg, order="F")
+    res, N = fill_voids.fill(
+      seg_cpy == segid, return_fill_count=True, output="holes"
+    )
+    assert N == np.count_nonzero(holes)
+
+    mask = np.where(seg_cpy == segid, seg_cpy, 0)
+    res, N = fill_voids.fill(mask, in_place=in_place, fill_value=segid, return_fill_count=True)
+    assert N == np.count_nonzero(holes)
+    assert np.all(res == np.where(holes, segid, mask))
+    if in_place:
+      assert np.shares_memory(res, mask)
+    else:
+      assert not np.any(mask[holes])
+
+  labels = np.ones((10,10,10), dtype=np.int16, order="F") * -3
+  labels[3:6,3:6,3:6] = 0
+  for arr in (labels, np.ascontiguousarray(labels)):
+    arr = np.copy(arr, order="K")
+    res = fill_voids.fill(arr, in_place=in_place, fill_value=-7)
+    assert res.dtype == np.int16
+    assert np.count_nonzero(res == -7) == 27
+    assert np.count_nonzero(res == -3) == 1000 - 27
+    assert np.all(res[:,:,0] == -3)
+
+  labels = fill_voids.fill(labels, in_place=in_place, fill_value=-7)
+  res = fill_voids.fill(labels, in_place=in_place, fill_value=5)
+  assert np.all(res == labels)
+  if not in_place:
+    assert not res.flags.writeable
+
+  with pytest.raises(ValueError):
+    fill_voids.fill(labels, fill_value=1, output="holes")
+
+  labels = np.copy(labels)
+  labels[3:6,3:6,3:6] = 0
+  labels.setflags(write=False)
+  if in_place:
+    with pytest.raises(ValueError):
+      fill_voids.fill(labels, in_place=True, fill_value=-7)
+  else:
+    assert np.count_nonzero(fill_voids.fill(labels, fill_value=-7) == -7) == 27
+
+@pytest.mark.parametrize("order", ["C", "F"])
+@pytest.mark.parametrize("out_dtype", [bool, np.uint8, np.uint32, np.float64])
+def test_out_parameter(order, out_dtype):
+  binimg = np.asarray(img == SEGIDS[0], order=order)
+  orig = np.copy(binimg)
+  expected = binary_fill_holes(binimg)
+
+  for out in (
+    np.zeros(binimg.shape, dtype=out_dtype, order="F"),
+    np.zeros(binimg.shape, dtype=out_dtype, order="C"),
+  ):
+    res, N = fill_voids.fill(binimg, out=out, return_fill_count=True)
+    assert res is out
+    assert np.all(out == expected)
+    assert N == np.count_nonzero(expected & ~binimg)
+    assert np.all(binimg == orig)
+
+  big = np.full((binimg.shape[0] + 2, binimg.shape[1], binimg.shape[2] + 3), 1, dtype=out_dtype)
+  view = big[1:-1, :, 2:-1]
+  fill_voids.fill(binimg, out=view, output="holes")
+  assert np.all(view == (expected & ~binimg))
+  assert np.all(big[0] == 1) and np.all(big[:,:,:2] == 1)
+
+  out = np.zeros(binimg.shape[:2], dtype=out_dtype)
+  fill_voids.fill(binimg[:,:,8], out=out)
+  assert np.all(out == binary_fill_holes(binimg[:,:,8]))
+
+  with pytest.raises(ValueError):
+    fill_voids.fill(binimg, out=np.zeros((2,2,2), dtype=out_dtype))
+
+def test_out_read_only(tmp_path):
+  binimg = img == SEGIDS[0]
+  path = str(tmp_path / "out.npy")
+  np.save(path, np.zeros(binimg.shape, dtype=np.uint8))
+
+  out = np.load(path, mmap_mode='r')
+  with pytest.raises(ValueError):
+    fill_voids.fill(binimg, out=out)
+  assert not np.any(np.load(path))
+
+  out = np.zeros(binimg.shape, dtype=bool)
+  out.setflags(write=False)
+  with pytest.raises(ValueError):
+    fill_voids.fill(binimg, out=out[:, ::-1])
+
+@pytest.mark.parametrize("order", ["C", "F"])
+def test_in_place_zero_copy(order):
+  binimg = np.asarray(img == SEGIDS[1], order=order)
+  expected = binary_fill_holes(binimg)
+
+  labels = np.copy(binimg, order=order)
+  res = fill_voids.fill(labels, in_place=True)
+  assert np.shares_memory(res, labels)
+  assert res.flags.c_contiguous == (order == "C")
+  assert np.all(res == expected)
+  assert np.all(labels == expected)
+
+  labels = np.copy(binimg[:,:,3], order=order).astype(np.float32)
+  res = fill_voids.fill(labels, in_place=True, output="holes")
+  assert np.shares_memory(res, labels)
+  assert np.all(labels == (binary_fill_holes(binimg[:,:,3]) & ~binimg[:,:,3]))
+
+@pytest.mark.parametrize("dtype", [ bool, np.uint8, np.uint32, np.float64 ])
+def test_strided_views(dtype):
+  binimg = (img == SEGIDS[1]).astype(dtype)
+  roi = (slice(20, 400, 2), slice(400, 10, -3), slice(None, None, -1))
+  view = binimg[roi]
+  assert not view.flags.c_contiguous and not view.flags.f_contiguous
+  expected = binary_fill_holes(np.copy(view))
+
+  assert fill_voids.count_voids(view) == np.count_nonzero(expected != view)
+  assert np.all(fill_voids.fill(view) == expected)
+  assert np.all(fill_voids.fill(view[:,:,5]) == binary_fill_holes(view[:,:,5]))
+  assert np.all(fill_voids.fill(view, output="holes") == (expected & ~view.astype(bool)))
+  assert np.all(fill_voids.fill(view.transpose(1,2,0)) == expected.transpose(1,2,0))
+
+  (sx, sy, sz) = view.shape
+  out = np.ones((sx * 2, sy * 3, sz * 2), dtype=np.uint16)[::2, ::-3, ::2]
+  fill_voids.fill(view, out=out)
+  assert np.all(out == expected)
+
+  if dtype != bool:
+    res = fill_voids.fill(view, fill_value=7)
+    assert np.all(res[expected != view] == 7)
+    assert np.all(res[expected == view] == view[expected == view])
+
+  # in_place edits the parent array through the view
+  parent = np.copy(binimg)
+  res = fill_voids.fill(parent[roi], in_place=True)
+  assert np.shares_memory(res, parent)
+  assert np.all(parent[roi] == expected)
+  outside = np.ones(parent.shape, dtype=bool)
+  outside[roi] = False
+  assert np.all(parent[outside] == binimg[outside])
+
+  parent.setflags(write=False)
+  with pytest.raises(ValueError):
+    fill_voids.fill(parent[roi], in_place=True)
+
+def test_unaligned_strides():
+  binimg = img[:, :, 30:60] == SEGIDS[1]
+  expected = binary_fill_holes(binimg)
+
+  # a field of a packed structured array has 5 byte strides
+  fields = np.zeros(binimg.shape, dtype=[ ('a', np.uint8), ('b', np.uint32) ])
+  fields['b'] = binimg
+  view = fields['b']
+  assert not view.flags.aligned and view.strides[-1] == 5
+
+  assert np.all(fill_voids.fill(view) == expected)
+  assert np.all(fill_voids.fill(view, out_dtype=bool, in_place=True) == expected)
+  assert fill_voids.count_voids(view) == np.count_nonzero(expected & ~binimg)
+  assert np.all(fill_voids.fill_labels(view) == expected)
+  assert np.all(fill_voids.fill_slices(view) == fill_voids.fill_slices(binimg))
+  assert np.all(fill_voids.fill_2p5d(view) == fill_voids.fill_2p5d(binimg))
+  assert np.all(fill_voids.fill(view[..., np.newaxis], batch_axes=3)[..., 0] == expected)
+
+  # written to through a copy
+  fill_voids.fill_many([ view ], in_place=True)
+  assert np.all(view == expected)
+  assert not np.any(fields['a'])
+
+  # can't be written to directly
+  fields['b'] = binimg
+  with pytest.raises(ValueError):
+    fill_voids.fill(view, in_place=True)
+  with pytest.raises(ValueError):
+    fill_voids.fill(view, in_place=True, fill_value=3)
+  with pytest.raises(ValueError):
+    fill_voids.fill(binimg, out=view)
+  with pytest.raises(ValueError):
+    fill_voids.fill_slices(view, in_place=True)
+  with pytest.raises(ValueError):
+    fill_voids.fill_labels(view, in_place=True)
+  with pytest.raises(ValueError):
+    fill_voids.fill(view[..., np.newaxis], batch_axes=3, in_place=True)
+  assert np.all(view == binimg)
+
+def test_dlpack_and_buffer_input(monkeypatch):
+  import types
+  binimg = np.asfortranarray(img[:,:,:20] == SEGIDS[1]).astype(np.uint8)
+  expected = binary_fill_holes(binimg)
+
+  # a minimal framework whose tensors only expose __dlpack__
+  framework = types.ModuleType("fakeframework")
+  class Tensor:
+    def __init__(self, arr):
+      self.arr = arr
+    def __dlpack__(self, *args, **kwargs):
+      return self.arr.__dlpack__(*args, **kwargs)
+    def __dlpack_device__(self):
+      return self.arr.__dlpack_device__()
+  Tensor.__module__ = "fakeframework"
+  framework.Tensor = Tensor
+  framework.from_dlpack = lambda x: Tensor(np.from_dlpack(x))
+  monkeypatch.setitem(sys.modules, "fakeframework", framework)
+
+  tensor = Tensor(np.copy(binimg, order="F"))
+  assert fill_voids.count_voids(tensor) == np.count_nonzero(expected != binimg)
+  assert fill_voids.has_holes(tensor)
+
+  res = fill_voids.fill(tensor)
+  assert isinstance(res, Tensor)
+  assert np.all(res.arr == expected)
+
+  res = fill_voids.fill(tensor, in_place=True)
+  assert isinstance(res, Tensor)
+  assert np.shares_memory(res.arr, tensor.arr)
+  assert np.all(tensor.arr == expected)
+
+  # nothing left to fill returns a new read-only tensor, not the input
+  res = fill_voids.fill(tensor)
+  assert isinstance(res, Tensor) and res is not tensor
+  assert not res.arr.flags.writeable
+  assert np.all(res.arr == tensor.arr)
+
+  # or a copy if the framework can't import read-only memory
+  def from_writeable_dlpack(x):
+    if not x.flags.writeable:
+      raise BufferError("read-only")
+    return Tensor(np.from_dlpack(x))
+  monkeypatch.setattr(framework, "from_dlpack", from_writeable_dlpack)
+  res = fill_voids.fill(tensor)
+  assert isinstance(res, Tensor) and res is not tensor
+  assert not np.shares_memory(res.arr, tensor.arr)
+  assert np.all(res.arr == tensor.arr)
+  monkeypatch.setattr(framework, "from_dlpack", lambda x: Tensor(np.from_dlpack(x)))
+
+  out = Tensor(np.zeros(binimg.shape, dtype=np.uint8))
+  assert fill_voids.fill(binimg, out=out) is out
+  assert np.all(out.arr == expected)
+
+  # buffer protocol
+  labels = np.copy(binimg)
+  res = fill_voids.fill(memoryview(labels), in_place=True)
+  assert isinstance(res, np.ndarray)
+  assert np.shares_memory(res, labels)
+  assert np.all(labels == expected)
+
+def test_threads():
+  from concurrent.futures import ThreadPoolExecutor
+  binimgs = [ 
+    np.asarray(img == segid, order=order).astype(dtype)
+    for segid in SEGIDS[:4]
+    for order, dtype in (("F", np.uint8), ("C", np.float32))
+  ]
+  expected = [ binary_fill_holes(binimg) for binimg in binimgs ]
+
+  with ThreadPoolExecutor(max_workers=4) as pool:
+    results = list(pool.map(fill_voids.fill, binimgs))
+    counts = list(pool.map(fill_voids.count_voids, binimgs))
+
+  for binimg, res, ct, ans in zip(binimgs, results, counts, expected):
+    assert np.all(res == ans)
+    assert ct == np.count_nonzero(ans != binimg)
+
+def test_free_threading():
+  import sysconfig
+  if not sysconfig.get_config_var("Py_GIL_DISABLED"):
+    pytest.skip("not a free-threaded build")
+  # importing fill_voids must not re-enable the GIL
+  assert not sys._is_gil_enabled()
+
+@pytest.mark.parametrize("threads", [ 0, 1, 3 ])
+def test_fill_many(threads):
+  binimgs = []
+  for i, segid in enumerate(SEGIDS):
+    binimg = img == segid
+    if i % 4 == 1:
+      binimg = np.ascontiguousarray(binimg).astype(np.float32)
+    elif i % 4 == 2:
+      binimg = binimg[:,:,i].astype(np.uint16)
+    elif i % 4 == 3:
+      binimg = binimg[::2, 10:80, ::-1].astype(np.int64)
+    binimgs.append(binimg)
+  binimgs.append(np.zeros((0,5,5), dtype=np.uint8))
+
+  expected = [ fill_voids.fill(binimg, return_fill_count=True) for binimg in binimgs ]
+  originals = [ np.copy(binimg) for binimg in binimgs ]
+
+  (results, counts) = fill_voids.fill_many(binimgs, threads=threads, return_fill_count=True)
+  assert len(results) == len(binimgs) == len(counts)
+  for binimg, res, ct, (ans, ans_ct) in zip(binimgs, results, counts, expected):
+    assert res.shape == binimg.shape
+    assert res.dtype == binimg.dtype
+    assert np.all(res == ans)
+    assert ct == ans_ct
+  assert any(ct > 0 for ct in counts)
+  assert all(np.all(binimg == orig) for binimg, orig in zip(binimgs, originals))
+
+  holes = fill_voids.fill_many(binimgs, threads=threads, output="holes")
+  for binimg, res in zip(binimgs, holes):
+    assert np.all(res == fill_voids.fill(binimg, output="holes"))
+
+  copies = [ np.copy(binimg) for binimg in binimgs[:-1] ]
+  views = [ binimg[::2] for binimg in copies ]
+  results = fill_voids.fill_many(views, threads=threads, in_place=True)
+  for binimg, view, res in zip(binimgs, views, results):
+    assert np.shares_memory(res, view)
+    assert np.all(view == fill_voids.fill(binimg[::2]))
+
+  # nothing is filled if any of the images is read-only
+  copies = [ np.copy(binimg) for binimg in binimgs[:2] ]
+  copies[1].setflags(write=False)
+  with pytest.raises(ValueError):
+    fill_voids.fill_many(copies, threads=threads, in_place=True)
+  assert np.all(copies[0] == binimgs[0])
+
+@pytest.mark.parametrize("order", [ "C", "F" ])
+def test_fill_many_singleton_axes(order):
+  # a 3D volume one voxel thick has no enclosed background,
+  # the singleton axis' faces are exterior
+  volumes = []
+  for shape in [ (5,5,1), (5,1,5), (1,5,5) ]:
+    labels = np.ones(shape, dtype=np.uint8, order=order)
+    labels[tuple( 2 if size > 1 else 0 for size in shape )] = 0
+    volumes.append(labels)
+
+  results, counts = fill_voids.fill_many(volumes, return_fill_count=True)
+  for labels, res, ct in zip(volumes, results, counts):
+    (expected, N) = fill_voids.fill(labels, return_fill_count=True)
+    assert N == 0
+    assert ct == N
+    assert np.all(res == expected)
+
+@pytest.mark.parametrize("axis", [ 0, 1, 2, -1 ])
+@pytest.mark.parametrize("order", [ "C", "F" ])
+def test_fill_slices(axis, order):
+  binimg = np.asarray(img == SEGIDS[1], order=order)
+  moved = np.moveaxis(binimg, axis, -1)
+  expected = np.stack([ binary_fill_holes(moved[:,:,k]) for k in range(moved.shape[2]) ], axis=-1)
+  expected = np.moveaxis(expected, -1, axis)
+
+  res, counts = fill_voids.fill_slices(binimg, axis=axis, threads=3, return_fill_count=True)
+  assert res.dtype == binimg.dtype
+  assert np.all(res == expected)
+  assert counts.shape == (binimg.shape[axis],)
+  assert np.all(counts == np.count_nonzero(np.moveaxis(expected != binimg, axis, -1), axis=(0,1)))
+  assert np.any(counts > 0)
+
+  res = fill_voids.fill_slices(binimg.astype(np.float32), axis=axis, output="holes")
+  assert np.all(res == (expected & ~binimg))
+
+  # views are edited in place through their strides
+  parent = binimg.astype(np.uint16)
+  view = parent[::2, ::-1, 1:]
+  expected = fill_voids.fill_slices(np.copy(view), axis=axis)
+  res = fill_voids.fill_slices(view, axis=axis, in_place=True)
+  assert np.shares_memory(res, parent)
+  assert np.all(view == expected)
+
+  parent.setflags(write=False)
+  with pytest.raises(ValueError):
+    fill_voids.fill_slices(parent[::2, ::-1, 1:], axis=axis, in_place=True)
+
+  with pytest.raises(fill_voids.DimensionError):
+    fill_voids.fill_slices(binimg[:,:,0])
+
+@pytest.mark.parametrize("order", [ "C", "F" ])
+def test_fill_2p5d(order):
+  binimg = np.asarray(img == SEGIDS[1], order=order)
+  votes = np.zeros(binimg.shape, dtype=np.uint8)
+  for axis in range(3):
+    votes += fill_voids.fill_slices(binimg, axis=axis, output="holes").view(np.uint8)
+
+  for combine, threshold in (("union", 1), ("vote", 2), ("intersection", 3)):
+    expected = binimg | (votes >= threshold)
+    res, ct = fill_voids.fill_2p5d(binimg, combine=combine, threads=3, return_fill_count=True)
+    assert res.dtype == binimg.dtype
+    assert np.all(res == expected)
+    assert ct == np.count_nonzero(expected != binimg)
+
+  view = binimg.astype(np.float32)[::-1, 10:, ::2]
+  res = fill_voids.fill_2p5d(view, combine="vote")
+  assert res.dtype == np.float32
+  assert np.all(res == fill_voids.fill_2p5d(np.copy(view), combine="vote"))
+
+  # yz planes large enough that fewer x slices fit in a block
+  tiled = np.asarray(np.tile(binimg[:70], (1, 3, 6)), order=order)
+  votes = np.zeros(tiled.shape, dtype=np.uint8)
+  for axis in range(3):
+    votes += fill_voids.fill_slices(tiled, axis=axis, output="holes").view(np.uint8)
+  res = fill_voids.fill_2p5d(tiled, combine="vote", threads=2)
+  assert np.all(res == (tiled | (votes >= 2)))
+
+  with pytest.raises(ValueError):
+    fill_voids.fill_2p5d(binimg, combine="majority")
+
+@pytest.mark.parametrize("order", [ "C", "F" ])
+@pytest.mark.parametrize("dtype", [ bool, np.uint32, np.float32 ])
+def test_batch_axes(order, dtype):
+  binimgs = [ img == segid for segid in SEGIDS[:3] ]
+  stack = np.asarray(np.stack(binimgs, axis=-1), order=order).astype(dtype)
+
+  res, counts = fill_voids.fill(stack, batch_axes=3, threads=2, return_fill_count=True)
+  assert res.shape == stack.shape and res.dtype == stack.dtype
+  assert counts.shape == (3,)
+  for t, binimg in enumerate(binimgs):
+    (ans, ct) = fill_voids.fill(binimg, return_fill_count=True)
+    assert np.all(res[..., t] == ans)
+    assert counts[t] == ct
+
+  # batch axes in front, two of them, 2D images, strided views
+  grid = np.moveaxis(stack, 3, 0)[:, np.newaxis, :, :, 5:40:3]
+  grid = np.concatenate([ grid, grid[:, :, ::-1] ], axis=1)
+  res, counts = fill_voids.fill(grid, batch_axes=(0, 4), output="holes", return_fill_count=True)
+  assert counts.shape == (3, grid.shape[4])
+  for t in range(3):
+    for z in range(grid.shape[4]):
+      ans = fill_voids.fill(np.copy(grid[t, :, :, :, z]), output="holes")
+      assert np.all(res[t, :, :, :, z] == ans)
+      assert counts[t, z] == np.count_nonzero(ans)
+
+  parent = np.copy(stack)
+  view = parent[::2, :, ::-1, :]
+  expected = fill_voids.fill(np.copy(view), batch_axes=(-1,))
+  res = fill_voids.fill(view, batch_axes=(-1,), in_place=True)
+  assert np.shares_memory(res, parent)
+  assert np.all(view == expected)
+
+  stack.setflags(write=False)
+  with pytest.raises(ValueError):
+    fill_voids.fill(stack, batch_axes=3, in_place=True)
+
+  with pytest.raises(fill_voids.DimensionError):
+    fill_voids.fill(stack[..., np.newaxis, np.newaxis], batch_axes=3)
+  with pytest.raises(ValueError):
+    fill_voids.fill(stack, batch_axes=3, out_dtype=bool)
+
+@pytest.mark.parametrize("order", ["C", "F"])
+def test_batch_axes_singleton_axes(order):
+  # 3D volumes with a size 1 spatial axis have no enclosed voxels
+  for shape in [ (5,5,1), (5,1,5), (1,5,5) ]:
+    vol = np.ones(shape, dtype=np.uint8)
+    vol[tuple( s // 2 for s in shape )] = 0
+    stack = np.asarray(np.stack([ vol ] * 3, axis=-1), order=order)
+
+    res, counts = fill_voids.fill(stack, batch_axes=3, return_fill_count=True)
+    assert np.all(counts == 0)
+    for t in range(3):
+      assert np.all(res[..., t] == fill_voids.fill(vol))
+
+@pytest.mark.parametrize("connectivity", [6, 18, 26])
+def test_connectivity3d(connectivity):
+  structure = scipy.ndimage.generate_binary_structure(3, { 6: 1, 18: 2, 26: 3 }[connectivity])
+
+  for segid in SEGIDS[:5]:
+    binimg = (img == segid).view(np.uint8)
+    binimg = binimg[scipy.ndimage.find_objects(binimg)[0]]
+    spy = binary_fill_holes(binimg, structure=structure)
+
+    fv, ct = fill_voids.fill(binimg, connectivity=connectivity, return_fill_count=True)
+    assert np.all(fv == spy)
+    assert ct == np.count_nonzero(spy) - np.count_nonzero(binimg)
+    assert fill_voids.count_voids(binimg, connectivity=connectivity) == ct
+
+    view = np.asfortranarray(binimg)[::-1, :, ::2]
+    spy = binary_fill_holes(view, structure=structure)
+    assert np.all(fill_voids.fill(view, connectivity=connectivity) == spy)
+    assert np.all(fill_voids.fill(np.copy(view), in_place=True, connectivity=connectivity) == spy)
+
+  # random noise has plenty of diagonal gaps
+  rng = np.random.default_rng(connectivity)
+  for _ in range(20):
+    noise = rng.random((13, 11, 9)) < 0.6
+    spy = binary_fill_holes(noise, structure=structure)
+    assert np.all(fill_voids.fill(noise, connectivity=connectivity) == spy)
+
+  # a void that only escapes through a corner
+  labels = np.ones((5,5,5), dtype=bool)
+  labels[2,2,2] = False
+  labels[1,1,1] = False
+  labels[0,0,0] = False
+  expected = np.ones((5,5,5), dtype=bool)
+  expected[0,0,0] = False
+  if connectivity == 26:
+    expected[1,1,1] = False
+    expected[2,2,2] = False
+  assert np.all(fill_voids.fill(labels, connectivity=connectivity) == expected)
+  assert fill_voids.has_holes(labels, connectivity=connectivity) == (connectivity != 26)
+
+@pytest.mark.parametrize("connectivity", [4, 8])
+def test_connectivity2d(connectivity):
+  structure = scipy.ndimage.generate_binary_structure(2, { 4: 1, 8: 2 }[connectivity])
+
+  for z in range(0, img.shape[2], 16):
+    binimg = img[:,:,z] == SEGIDS[0]
+    spy = binary_fill_holes(binimg, structure=structure)
+    assert np.all(fill_voids.fill(binimg, connectivity=connectivity) == spy)
+
+  rng = np.random.default_rng(connectivity)
+  noise = rng.random((40, 60)) < 0.6
+  spy = binary_fill_holes(noise, structure=structure)
+  assert np.all(fill_voids.fill(noise, connectivity=connectivity) == spy)
+  assert np.all(fill_voids.fill_many([ noise ], connectivity=connectivity)[0] == spy)
+
+  volume = rng.random((30, 20, 10)) < 0.6
+  res = fill_voids.fill_slices(volume, axis=1, connectivity=connectivity)
+  for y in range(volume.shape[1]):
+    assert np.all(res[:, y, :] == binary_fill_holes(volume[:, y, :], structure=structure))
+
+  stack = np.stack([ noise, ~noise ], axis=-1)
+  res = fill_voids.fill(stack, batch_axes=2, connectivity=connectivity)
+  assert np.all(res[..., 0] == spy)
+
+def test_connectivity_validation():
+  with pytest.raises(ValueError):
+    fill_voids.fill(np.zeros((5,5,5), dtype=bool), connectivity=8)
+  with pytest.raises(ValueError):
+    fill_voids.fill(np.zeros((5,5), dtype=bool), connectivity=26)
+  with pytest.raises(ValueError):
+    fill_voids.fill_slices(np.zeros((5,5,5), dtype=bool), connectivity=6)
+
+def _filter_holes(binimg, holes, max_size, max_extent, structure=None):
+  components, n = scipy.ndimage.label(holes, structure=structure)
+  keep = np.zeros(holes.shape, dtype=bool)
+  for i, slices in enumerate(scipy.ndimage.find_objects(components)):
+    void = components[slices] == i + 1
+    extent = [ s.stop - s.start for s in slices ]
+    if np.count_nonzero(void) <= max_size and all(e <= m for e, m in zip(extent, max_extent)):
+      keep[slices] |= void
+  return binimg | keep
+
+@pytest.mark.parametrize("connectivity", [6, 26])
+@pytest.mark.parametrize("order", ['C', 'F'])
+def test_max_hole_size(connectivity, order):
+  structure = scipy.ndimage.generate_binary_structure(3, 1 if connectivity == 6 else 3)
+  rng = np.random.default_rng(44)
+
+  for _ in range(10):
+    noise = np.asarray(rng.random((15, 12, 10)) < 0.65, order=order)
+    holes = fill_voids.fill(noise, output="holes", connectivity=connectivity)
+    inf = np.iinfo(np.int64).max
+
+    for max_size, max_extent in [ (3, None), (0, None), (None, 2), (None, (1, 3, 2)), (5, (3, None, 2)) ]:
+      ext = max_extent if max_extent is not None else inf
+      ext = [ext] * 3 if np.isscalar(ext) else [ inf if e is None else e for e in ext ]
+      expected = _filter_holes(noise, holes, inf if max_size is None else max_size, ext, structure)
+
+      res, ct = fill_voids.fill(
+        noise, max_hole_size=max_size, max_hole_extent=max_extent, 
+        connectivity=connectivity, return_fill_count=True
+      )
+      assert np.all(res == expected)
+      assert ct == np.count_nonzero(expected) - np.count_nonzero(noise)
+
+      kwargs = dict(max_hole_size=max_size, max_hole_extent=max_extent, connectivity=connectivity)
+      assert np.all(fill_voids.fill(noise, output="holes", **kwargs) == (expected & ~noise))
+      assert np.all(fill_voids.fill(noise, output="exterior", **kwargs) == ~expected)
+      assert np.all(fill_voids.fill(np.copy(noise), in_place=True, **kwargs) == expected)
+      assert np.all(fill_voids.fill(noise[:, ::-1], **kwargs) == expected[:, ::-1])
+      bits = fill_voids.fill(noise, output_format="packed", **kwargs)
+      assert np.all(np.unpackbits(bits, count=noise.size).reshape(noise.shape, order='F') == expected)
+
+  img2d = np.ones((9, 9), dtype=np.uint8)
+  img2d[1:3, 1:3] = 0 # 4 voxels
+  img2d[5:8, 5:6] = 0 # 3 voxels, 3 long
+  assert np.all(fill_voids.fill(img2d, max_hole_size=3)[1:3, 1:3] == 0)
+  assert fill_voids.fill(img2d, max_hole_size=3, return_fill_count=True)[1] == 3
+  assert fill_voids.fill(img2d, max_hole_extent=(2, 2), return_fill_count=True)[1] == 4
+  assert fill_voids.fill(img2d, max_hole_extent=(3, 1), return_fill_count=True)[1] == 3
+
+  with pytest.raises(ValueError):
+    fill_voids.fill(img2d, max_hole_extent=(3, 3, 3))
+  with pytest.raises(ValueError):
+    fill_voids.fill(img2d, max_hole_size=-1)
+  with pytest.raises(ValueError):
+    fill_voids.fill(img2d[..., np.newaxis], batch_axes=2, max_hole_size=3)
+
+@pytest.mark.parametrize("order", ['C', 'F'])
+@pytest.mark.parametrize("ndim", [2, 3])
+def test_return_holes(order, ndim):
+  rng = np.random.default_rng(45)
+  shape = (40, 30) if ndim == 2 else (15, 12, 10)
+  noise = np.asarray(rng.random(shape) < 0.65, order=order)
+
+  filled, ct, holes = fill_voids.fill(noise, return_fill_count=True, return_holes=True)
+  assert np.all(filled == fill_voids.fill(noise))
+
+  components, n = scipy.ndimage.label(filled & ~noise)
+  assert len(holes["voxel_counts"]) == n
+  assert len(holes["bounding_boxes"]) == n
+  assert holes["centroids"].shape == (n, ndim)
+  assert np.sum(holes["voxel_counts"]) == ct
+
+  bbox_key = lambda slices: tuple((s.start, s.stop) for s in slices)
+  expected = {}
+  for i, slices in enumerate(scipy.ndimage.find_objects(components)):
+    expected[bbox_key(slices)] = (
+      np.count_nonzero(components == i + 1),
+      scipy.ndimage.center_of_mass(components == i + 1),
+    )
+  for count, bbox, centroid in zip(holes["voxel_counts"], holes["bounding_boxes"], holes["centroids"]):
+    (ans_count, ans_centroid) = expected[bbox_key(bbox)]
+    assert count == ans_count
+    assert np.allclose(centroid, ans_centroid)
+
+  # only the voids that were filled are listed
+  res, holes = fill_voids.fill(noise, max_hole_size=2, return_holes=True)
+  assert np.all(holes["voxel_counts"] <= 2)
+  assert np.sum(holes["voxel_counts"]) == np.count_nonzero(res) - np.count_nonzero(noise)
+
+  res, holes = fill_voids.fill(np.ones(shape, dtype=bool), return_holes=True)
+  assert holes["voxel_counts"].size == 0
+  assert holes["centroids"].shape == (0, ndim)
+
+  with pytest.raises(ValueError):
+    fill_voids.fill(noise[..., np.newaxis], batch_axes=ndim, return_holes=True)
+
+def _fill_with_boundary(img, boundary):
+  # open faces border a layer of background, closed faces a wall,
+  # and seed masks a layer that is background only where they're set
+  padded = np.pad(img.astype(bool), 1, constant_values=False)
+  inner = tuple([ slice(1, -1) ] * img.ndim)
+  for face, policy in enumerate(boundary):
+    axis = face // 2
+    layer = list(inner)
+    layer[axis] = 0 if face % 2 == 0 else -1
+    if isinstance(policy, str):
+      padded[tuple(layer)] = (policy == "closed")
+    else:
+      padded[tuple(layer)] = ~policy.astype(bool)
+  return scipy.ndimage.binary_fill_holes(padded)[inner]
+
+@pytest.mark.parametrize("order", ['C', 'F'])
+@pytest.mark.parametrize("ndim", [2, 3])
+def test_boundary(order, ndim):
+  rng = np.random.default_rng(46)
+  shape = (40, 30) if ndim == 2 else (15, 12, 10)
+
+  for _ in range(5):
+    noise = np.asarray(rng.random(shape) < 0.55, order=order)
+    boundary = []
+    for face in range(2 * ndim):
+      face_shape = tuple( size for i, size in enumerate(shape) if i != face // 2 )
+      policy = rng.integers(3)
+      if policy == 2:
+        boundary.append(rng.random(face_shape) < 0.3)
+      else:
+        boundary.append([ "open", "closed" ][policy])
+
+    expected = _fill_with_boundary(noise, boundary)
+    res, ct = fill_voids.fill(noise, boundary=boundary, return_fill_count=True)
+    assert np.all(res == expected)
+    assert ct == np.count_nonzero(expected) - np.count_nonzero(noise)
+    assert np.all(fill_voids.fill(noise, boundary=boundary, output="exterior") == ~expected)
+    assert np.all(fill_voids.fill(np.copy(noise), in_place=True, boundary=boundary) == expected)
+
+  noise = np.asarray(rng.random(shape) < 0.55, order=order)
+  assert np.all(fill_voids.fill(noise, boundary="open") == fill_voids.fill(noise))
+  assert np.all(fill_voids.fill(noise, boundary="closed") == 1)
+
+  # a chunk seeded with its neighbor's exterior across the seam
+  # matches the same region of the whole image
+  exterior = fill_voids.fill(noise, output="exterior")
+  half = shape[0] // 2
+  boundary = [ "open" ] * (2 * ndim)
+  boundary[1] = exterior[half]
+  assert np.all(fill_voids.fill(noise[:half], boundary=boundary) == ~exterior[:half])
+  boundary = [ "open" ] * (2 * ndim)
+  boundary[0] = exterior[half - 1]
+  assert np.all(fill_voids.fill(noise[half:], boundary=boundary) == ~exterior[half:])
+
+  with pytest.raises(ValueError):
+    fill_voids.fill(noise, boundary=[ "open" ] * 3)
+  with pytest.raises(ValueError):
+    fill_voids.fill(noise, boundary="ajar")
+  with pytest.raises(ValueError):
+    fill_voids.fill(noise, boundary=[ np.ones((2, 2), dtype=bool) ] + [ "open" ] * (2 * ndim - 1))
+  with pytest.raises(ValueError):
+    fill_voids.fill(noise[..., np.newaxis], batch_axes=ndim, boundary="closed")
+
+@pytest.mark.parametrize("order", ['C', 'F'])
+@pytest.mark.parametrize("ndim", [2, 3])
+def test_seeds(order, ndim):
+  rng = np.random.default_rng(47)
+  shape = (40, 30) if ndim == 2 else (15, 12, 10)
+
+  for connectivity in ([4, 8] if ndim == 2 else [6, 26]):
+    structure = scipy.ndimage.generate_binary_structure(ndim, 1 if connectivity in (4, 6) else ndim)
+    for _ in range(5):
+      noise = np.asarray(rng.random(shape) < 0.45, order=order)
+      components, n = scipy.ndimage.label(~noise, structure=structure)
+
+      coords = np.stack([ rng.integers(size, size=4) for size in shape ], axis=1)
+      exterior = np.isin(components, components[tuple(coords.T)][components[tuple(coords.T)] > 0])
+      res, ct = fill_voids.fill(noise, seeds=coords, connectivity=connectivity, return_fill_count=True)
+      assert np.all(res == ~exterior)
+      assert ct == np.count_nonzero(~exterior) - np.count_nonzero(noise)
+      assert np.all(fill_voids.fill(noise, seeds=[ tuple(c) for c in coords ], connectivity=connectivity) == ~exterior)
+      assert np.all(fill_voids.fill(np.copy(noise), in_place=True, seeds=coords, connectivity=connectivity) == ~exterior)
+
+      mask = np.asarray(rng.random(shape) < 0.01, order=order)
+      exterior = np.isin(components, components[mask][components[mask] > 0])
+      assert np.all(fill_voids.fill(noise, seeds=mask, connectivity=connectivity) == ~exterior)
+      assert np.all(fill_voids.fill(noise, seeds=mask, connectivity=connectivity, output="exterior") == exterior)
+
+      # seeds are added to the open faces when asked for
+      exterior |= fill_voids.fill(noise, output="exterior", connectivity=connectivity)
+      assert np.all(fill_voids.fill(noise, seeds=mask, boundary="open", connectivity=connectivity) == ~exterior)
+
+  noise = np.asarray(rng.random(shape) < 0.45, order=order)
+  assert np.all(fill_voids.fill(noise, seeds=np.zeros(shape, dtype=bool)) == 1)
+  assert np.all(fill_voids.fill(noise, seeds=np.zeros((0, ndim), dtype=int)) == 1)
+  assert np.all(fill_voids.fill(noise, seeds=~noise) == noise)
+
+  with pytest.raises(ValueError):
+    fill_voids.fill(noise, seeds=[ shape ])
+  with pytest.raises(ValueError):
+    fill_voids.fill(noise, seeds=[ (-1,) * ndim ])
+  with pytest.raises(ValueError):
+    fill_voids.fill(noise, seeds=np.zeros((3, ndim + 1), dtype=int))
+  with pytest.raises(ValueError):
+    fill_voids.fill(noise, seeds=np.zeros((2, 2, 2, 2), dtype=bool))
+  with pytest.raises(ValueError):
+    fill_voids.fill(noise[..., np.newaxis], batch_axes=ndim, seeds=[ (0,) * ndim ])
+
+@pytest.mark.parametrize("order", ['C', 'F'])
+@pytest.mark.parametrize("ndim", [2, 3])
+def test_domain(order, ndim):
+  rng = np.random.default_rng(48)
+  shape = (40, 30) if ndim == 2 else (15, 12, 10)
+
+  for connectivity in ([4, 8] if ndim == 2 else [6, 18, 26]):
+    structure = scipy.ndimage.generate_binary_structure(ndim, 1 if connectivity in (4, 6) else (2 if connectivity == 18 else ndim))
+    for _ in range(5):
+      noise = np.asarray(rng.random(shape) < 0.55, order=order)
+      domain = np.asarray(rng.random(shape) >= 0.05, order=order)
+
+      # the space outside of the domain and the border are the exterior
+      components, n = scipy.ndimage.label(~noise | ~domain, structure=structure)
+      border = np.pad(np.zeros([ s - 2 for s in shape ], dtype=bool), 1, constant_values=True)
+      exterior = np.isin(components, components[~domain | (border & (components > 0))])
+      expected = np.where(domain, ~exterior, noise)
+
+      res, ct = fill_voids.fill(noise, domain=domain, connectivity=connectivity, return_fill_count=True)
+      assert np.all(res == expected)
+      assert ct == np.count_nonzero(expected) - np.count_nonzero(noise)
+      assert np.all(fill_voids.fill(noise, domain=domain.astype(np.uint8), connectivity=connectivity) == expected)
+      assert np.all(fill_voids.fill(np.copy(noise), in_place=True, domain=domain, connectivity=connectivity) == expected)
+      assert np.all(fill_voids.fill(noise, output="holes", domain=domain, connectivity=connectivity) == (expected & ~noise))
+
+  # a padded dataset behaves like the cropped one
+  noise = np.asarray(rng.random(shape) < 0.55, order=order)
+  padded = np.pad(noise, 3, constant_values=True)
+  domain = np.pad(np.ones(shape, dtype=bool), 3, constant_values=False)
+  inner = tuple([ slice(3, -3) ] * ndim)
+  res = fill_voids.fill(padded, domain=domain)
+  assert np.all(res[inner] == fill_voids.fill(noise))
+  assert np.all(res[~domain])
+
+  assert np.all(fill_voids.fill(noise, domain=np.ones(shape, dtype=bool)) == fill_voids.fill(noise))
+  assert np.all(fill_voids.fill(noise, domain=np.zeros(shape, dtype=bool)) == noise)
+
+  with pytest.raises(ValueError):
+    fill_voids.fill(noise, domain=np.ones((2,) * ndim, dtype=bool))
+  with pytest.raises(ValueError):
+    fill_voids.fill(noise[..., np.newaxis], batch_axes=ndim, domain=np.ones(shape + (1,), dtype=bool))
+
+@pytest.mark.parametrize("order", ['C', 'F'])
+@pytest.mark.parametrize("dtype", [np.uint8, np.int16, np.uint32, np.int64, np.uint64, np.float32, np.float64])
+def test_foreground_predicates(order, dtype):
+  rng = np.random.default_rng(49)
+  shape = (15, 12, 10)
+  seg = np.asarray(rng.integers(0, 4, size=shape), order=order).astype(dtype, order=order)
+  if np.issubdtype(dtype, np.signedinteger) or np.issubdtype(dtype, np.floating):
+    seg[rng.random(shape) < 0.2] = -3
+
+  for segid in [0, 1, 3, -3]:
+    binimg = (seg == segid)
+    res, ct = fill_voids.fill(seg, foreground=segid, return_fill_count=True)
+    assert res.dtype == bool
+    assert np.all(res == fill_voids.fill(binimg))
+    assert ct == fill_voids.fill(binimg, return_fill_count=True)[1]
+    assert np.all(fill_voids.fill(seg, foreground=segid, output="holes") == fill_voids.fill(binimg, output="holes"))
+    assert np.all(fill_voids.fill(seg[:, ::-1], foreground=segid) == fill_voids.fill(binimg[:, ::-1]))
+
+  ids = [1, 3, 3]
+  assert np.all(fill_voids.fill(seg, foreground=ids) == fill_voids.fill(np.isin(seg, ids)))
+  assert np.all(fill_voids.fill(seg, foreground=np.array([2, 0])) == fill_voids.fill(np.isin(seg, [0, 2])))
+  # ids that can't occur match nothing
+  assert np.all(fill_voids.fill(seg, foreground=[2.5]) == 0)
+  assert np.all(fill_voids.fill(seg, foreground=[1, 2**70]) == fill_voids.fill(seg == 1))
+
+  for t in [-4, -3, -0.5, 0, 1.5, 2, 3, 1e30, -np.inf]:
+    assert np.all(fill_voids.fill(seg, threshold=t) == fill_voids.fill(seg > t))
+  assert np.all(fill_voids.fill(seg, threshold=np.nan) == 0)
+
+  if np.issubdtype(dtype, np.floating):
+    # thresholds beyond the dtype's range don't overflow
+    extreme = np.copy(seg)
+    extreme.flat[:3] = [ np.finfo(dtype).max, np.inf, -np.inf ]
+    with warnings.catch_warnings():
+      warnings.simplefilter("error")
+      for t in [1e300, -1e300, float(np.finfo(dtype).max)]:
+        expected = fill_voids.fill(extreme.astype(np.float64) > t)
+        assert np.all(fill_voids.fill(extreme, threshold=t) == expected)
+
+  # close the holes of one segment in place
+  expected = np.copy(seg)
+  expected[fill_voids.fill(seg == 1, output="holes")] = 1
+  edited = np.copy(seg)
+  fill_voids.fill(edited, foreground=1, fill_value=1, in_place=True)
+  assert np.all(edited == expected)
+  assert np.all(fill_voids.fill(seg, foreground=1, fill_value=1) == expected)
+
+  edited = np.copy(seg)
+  fill_voids.fill(edited, foreground=1, in_place=True)
+  assert np.all(edited == fill_voids.fill(seg == 1))
+  assert fill_voids.fill(seg, foreground=1, out_dtype=np.uint16).dtype == np.uint16
+
+  with pytest.raises(ValueError):
+    fill_voids.fill(seg, foreground=1, threshold=1)
+  with pytest.raises(ValueError):
+    fill_voids.fill(seg[..., np.newaxis], batch_axes=3, foreground=1)
+
+def _fill_labels_reference(seg, structure):
+  res = np.copy(seg)
+  components, n = scipy.ndimage.label(seg == 0, structure=structure)
+  border = np.pad(np.zeros([ s - 2 for s in seg.shape ], dtype=bool), 1, constant_values=True)
+  for i in range(1, n + 1):
+    component = (components == i)
+    if np.any(component & border):
+      continue
+    around = scipy.ndimage.binary_dilation(component, structure=structure) & ~component
+    enclosing = np.unique(seg[around])
+    if len(enclosing) == 1:
+      res[component] = enclosing[0]
+  return res
+
+@pytest.mark.parametrize("order", ['C', 'F'])
+@pytest.mark.parametrize("dtype", [np.uint8, np.int16, np.uint64, np.float32])
+def test_fill_labels(order, dtype):
+  rng = np.random.default_rng(50)
+
+  for ndim, connectivities in [ (2, [4, 8]), (3, [6, 18, 26]) ]:
+    shape = (30, 25) if ndim == 2 else (12, 11, 10)
+    for connectivity in connectivities:
+      rank = { 4: 1, 8: 2, 6: 1, 18: 2, 26: 3 }[connectivity]
+      structure = scipy.ndimage.generate_binary_structure(ndim, rank)
+      for _ in range(3):
+        seg = rng.integers(1, 4, size=shape).astype(dtype)
+        seg[rng.random(shape) < 0.4] = 0
+        seg = np.asarray(seg, order=order)
+        expected = _fill_labels_reference(seg, structure)
+
+        res, ct = fill_voids.fill_labels(seg, return_fill_count=True, connectivity=connectivity)
+        assert res.dtype == seg.dtype
+        assert np.all(res == expected)
+        assert ct == np.count_nonzero(expected != seg)
+
+        edited = np.copy(seg)
+        assert fill_voids.fill_labels(edited, in_place=True, connectivity=connectivity) is edited
+        assert np.all(edited == expected)
+        assert np.all(fill_voids.fill_labels(seg[:, ::-1], connectivity=connectivity) == expected[:, ::-1])
+
+  # a binary image is filled like fill does
+  binimg = np.asarray(rng.random((12, 11, 10)) < 0.6, order=order)
+  assert np.all(fill_voids.fill_labels(binimg) == fill_voids.fill(binimg))
+
+  # nested labels are kept, holes of each are filled with it
+  seg = np.zeros((9, 9, 9), dtype=dtype)
+  seg[1:8, 1:8, 1:8] = 1
+  seg[3:6, 3:6, 3:6] = 2
+  seg[4, 4, 4] = 0
+  seg[1, 1, 1] = 0
+  res = fill_voids.fill_labels(seg)
+  assert res[4, 4, 4] == 2
+  assert res[1, 1, 1] == 0
+  assert np.count_nonzero(res == 2) == 27
+
+  seg.setflags(write=False)
+  with pytest.raises(ValueError):
+    fill_voids.fill_labels(seg, in_place=True)
+  assert seg[4, 4, 4] == 0
+
+  with pytest.raises(fill_voids.DimensionError):
+    fill_voids.fill_labels(np.zeros((2, 2, 2, 2), dtype=dtype))
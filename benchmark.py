@@ -0,0 +1,61 @@
+"""
+Measures how fill scales across threads by filling every
+label of the test volume with 1, 2, 4, ... threads.
+
+On a free-threaded interpreter (e.g. python3.13t) or a
+regular one (the fill releases the GIL), the speedup
+should approach the number of cores for large labels.
+
+Usage: python benchmark.py [max_threads]
+"""
+import os
+import sys
+import sysconfig
+import time
+from concurrent.futures import ThreadPoolExecutor
+
+import crackle
+import numpy as np
+
+import fill_voids
+
+def gil_enabled():
+  if hasattr(sys, "_is_gil_enabled"):
+    return sys._is_gil_enabled()
+  return True
+
+def run(binimgs, threads):
+  start = time.time()
+  with ThreadPoolExecutor(max_workers=threads) as pool:
+    list(pool.map(fill_voids.fill, binimgs))
+  return time.time() - start
+
+def main():
+  max_threads = int(sys.argv[1]) if len(sys.argv) > 1 else (os.cpu_count() or 1)
+
+  labels = crackle.load("test_data.npy.ckl.gz")
+  segids = np.unique(labels)[1:]
+  binimgs = [ np.asfortranarray(labels == segid) for segid in segids ]
+
+  print("Python {} free-threaded build: {} GIL enabled: {}".format(
+    sys.version.split()[0],
+    bool(sysconfig.get_config_var("Py_GIL_DISABLED")),
+    gil_enabled()
+  ))
+  print("{} labels of shape {}".format(len(binimgs), labels.shape))
+
+  run(binimgs, 1) # warm up
+
+  baseline = None
+  threads = 1
+  while threads <= max_threads:
+    elapsed = min(run(binimgs, threads) for _ in range(3))
+    if baseline is None:
+      baseline = elapsed
+    print("threads: {:>3}  {:.3f} sec  speedup: {:.2f}x".format(
+      threads, elapsed, baseline / elapsed
+    ))
+    threads *= 2
+
+if __name__ == "__main__":
+  main()
@@ -1,7 +1,13 @@
-from .fill_voids import DimensionError, fill, void_shard
+from .fill_voids import DimensionError, count_voids, fill, fill_2p5d, fill_labels, fill_many, fill_slices, has_holes, void_shard
 
 __all__ = [
     "DimensionError",
+    "count_voids",
     "fill",
+    "fill_2p5d",
+    "fill_labels",
+    "fill_many",
+    "fill_slices",
+    "has_holes",
     "void_shard",
 ]
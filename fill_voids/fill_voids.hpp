@@ -24,12 +24,16 @@
 #define FILLVOIDS_HPP
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstdio>
 #include <cstdint>
+#include <exception>
+#include <mutex>
 #include <vector>
 #include <stack>
 #include <string>
+#include <thread>
 
 #include "libdivide.h"
 
@@ -38,15 +42,142 @@ namespace fill_voids {
 enum Label {
   BACKGROUND = 0,
   VISITED_BACKGROUND = 1,
-  FOREGROUND = 2
+  FOREGROUND = 2,
+  MEASURED_VOID = 3 // see filter_voids
 };
 
+// What the final pass writes out as 1.
+// FILLED: foreground and voids
+// HOLES: voids only
+// EXTERIOR: background reachable from the image edge
+enum OutputMode {
+  FILLED = 0,
+  HOLES = 1,
+  EXTERIOR = 2
+};
+
+// How a face of the image seeds the exterior flood.
+// OPEN: all background on the face is exterior (default)
+// CLOSED: the face is a wall, e.g. a seam between chunks
+// SEEDED: only background where the face's seed mask is set
+enum FacePolicy {
+  OPEN = 0,
+  CLOSED = 1,
+  SEEDED = 2
+};
+
+/* Per face seeding of the exterior flood in the order 
+ * x = 0, x = sx - 1, y = 0, y = sy - 1, z = 0, z = sz - 1 
+ * (2D images use the first four). seeds[f] is only read 
+ * for SEEDED faces and is a mask over the face's two 
+ * other axes in Fortran order, e.g. sy * sz for the x faces.
+ *
+ * The exterior can also be seeded anywhere in the image, 
+ * e.g. from a known extracellular label, by num_points
+ * locations x + sx * (y + sy * z) in points and/or by a 
+ * Fortran ordered sx * sy * sz mask (null if unused).
+ * Seeds that land on foreground are ignored.
+ *
+ * domain, if not null, is a Fortran ordered sx * sy * sz 
+ * mask of valid data. Voxels outside of it keep their 
+ * label and are never flooded, but background touching 
+ * them is exterior (see mark_outside_domain).
+ */
+struct Boundaries {
+  FacePolicy faces[6];
+  const uint8_t* seeds[6];
+  const size_t* points;
+  size_t num_points;
+  const uint8_t* mask;
+  const uint8_t* domain;
+};
+
+// Which voxels of the input are foreground.
+// NONZERO: value != 0 (default)
+// EQUAL: value == values[0], e.g. one segment id
+// ANY_OF: value is one of num_values sorted values
+// IN_RANGE: values[0] <= value <= values[1], e.g. a 
+//   threshold. If values[0] > values[1] the range wraps 
+//   around: value >= values[0] || value <= values[1]
+enum ForegroundKind {
+  NONZERO = 0,
+  EQUAL = 1,
+  ANY_OF = 2,
+  IN_RANGE = 3
+};
+
+/* Picks the foreground out of a segmentation or 
+ * grayscale image while it's marked (see mark_foreground)
+ * so no binary copy of it has to be made first. values
+ * holds num_values values of the image's type.
+ */
+struct Foreground {
+  ForegroundKind kind;
+  const void* values;
+  size_t num_values;
+};
+
+/* Holds a Label for each voxel in 2 bits 
+ * so that read-only images can be flooded 
+ * without allocating a full size copy of
+ * the image. Storage is provided by the caller
+ * and must be zeroed (all BACKGROUND).
+ */
+class PackedLabels {
+public:
+  uint8_t* data;
+
+  PackedLabels(uint8_t* data) : data(data) {}
+
+  static size_t bytes(const size_t voxels) {
+    return (voxels + 3) >> 2;
+  }
+
+  inline uint8_t operator[](const size_t loc) const {
+    return (data[loc >> 2] >> ((loc & 0x3) << 1)) & 0x3;
+  }
+
+  inline void set_foreground(const size_t loc) {
+    data[loc >> 2] |= static_cast<uint8_t>(Label::FOREGROUND << ((loc & 0x3) << 1));
+  }
+
+  inline void visit(const size_t loc) {
+    data[loc >> 2] |= static_cast<uint8_t>(Label::VISITED_BACKGROUND << ((loc & 0x3) << 1));
+  }
+
+  inline void set(const size_t loc, const uint8_t label) {
+    const int shift = (loc & 0x3) << 1;
+    data[loc >> 2] = static_cast<uint8_t>(
+      (data[loc >> 2] & ~(0x3 << shift)) | (label << shift)
+    );
+  }
+};
+
+template <typename T>
+inline void visit(T* labels, const size_t loc) {
+  labels[loc] = Label::VISITED_BACKGROUND;
+}
+
+inline void visit(PackedLabels& labels, const size_t loc) {
+  labels.visit(loc);
+}
+
 template <typename T>
+inline void set_label(T* labels, const size_t loc, const uint8_t label) {
+  labels[loc] = label;
+}
+
+inline void set_label(PackedLabels& labels, const size_t loc, const uint8_t label) {
+  labels.set(loc, label);
+}
+
+template <typename LABELS>
 inline void push_stack(
-  T* labels, const size_t loc,
-  std::stack<size_t> &stack, bool &placed
+  LABELS& labels, const size_t loc,
+  std::stack<size_t> &stack, bool &placed,
+  const uint8_t label = Label::BACKGROUND
 ) {
-  if (labels[loc] == 0) {
+  if (labels[loc] == label) {
     if (!placed) {
       stack.push(loc);
     }
@@ -57,9 +188,9 @@ inline void push_stack(
   }  
 }
 
-template <typename T>
+template <typename LABELS>
 inline void add_neighbors(
-  T* visited, std::stack<size_t> &stack,
+  LABELS& visited, std::stack<size_t> &stack,
   const size_t sx, const size_t sy,
   const size_t cur, const size_t y,
   bool &yplus, bool &yminus
@@ -89,9 +220,9 @@ inline void add_neighbors(
   }
 }
 
-template <typename T>
+template <typename LABELS>
 inline void add_neighbors(
-  T* visited, std::stack<size_t> &stack,
+  LABELS& visited, std::stack<size_t> &stack,
   const size_t sx, const size_t sy, const size_t sz, 
   const size_t cur, const size_t y, const size_t z,
   bool &yplus, bool &yminus, bool &zplus, bool &zminus
@@ -149,9 +280,9 @@ inline void add_neighbors(
  * void (defined as touching the edge of the 
  * image) is first encountered.
  */
-template <typename T>
+template <typename LABELS>
 void initialize_stack(
-    T* labels, 
+    LABELS& labels, 
     const size_t sx, const size_t sy,
     std::stack<size_t> &stack
   ) {
@@ -162,10 +293,10 @@ void initialize_stack(
   size_t loc;
   for (size_t x = 0; x < sx; x++) {
     loc = x;
-    push_stack<T>(labels, loc, stack, placed_front);
+    push_stack<LABELS>(labels, loc, stack, placed_front);
     
     loc = x + sx * (sy - 1);
-    push_stack<T>(labels, loc, stack, placed_back);
+    push_stack<LABELS>(labels, loc, stack, placed_back);
   }
 
   placed_front = false;
@@ -173,10 +304,10 @@ void initialize_stack(
 
   for (size_t y = 0; y < sy; y++) {
     loc = sx * y;
-    push_stack<T>(labels, loc, stack, placed_front);
+    push_stack<LABELS>(labels, loc, stack, placed_front);
     
     loc = (sx - 1) + sx * y;
-    push_stack<T>(labels, loc, stack, placed_back);
+    push_stack<LABELS>(labels, loc, stack, placed_back);
   }
 }
 
@@ -192,9 +323,9 @@ void initialize_stack(
  * which exploits the knowledge that that border touches
  * everything and will find those exterior voids automatically.
  */
-template <typename T>
+template <typename LABELS>
 void initialize_stack(
-    T* labels, 
+    LABELS& labels, 
     const size_t sx, const size_t sy, const size_t sz,
     std::stack<size_t> &stack
   ) {
@@ -205,12 +336,15 @@ void initialize_stack(
 
   size_t loc;
   for (size_t y = 0; y < sy; y++) {
+    // rows on a face are not adjacent end to end
+    placed_front = false;
+    placed_back = false;
     for (size_t x = 0; x < sx; x++) {
       loc = x + sx * y;
-      push_stack<T>(labels, loc, stack, placed_front);
+      push_stack<LABELS>(labels, loc, stack, placed_front);
       
       loc = x + sx * y + sxy * (sz - 1);
-      push_stack<T>(labels, loc, stack, placed_back);
+      push_stack<LABELS>(labels, loc, stack, placed_back);
     }
   }
 
@@ -218,12 +352,14 @@ void initialize_stack(
   placed_back = false;
 
   for (size_t z = 0; z < sz; z++) {
+    placed_front = false;
+    placed_back = false;
     for (size_t x = 0; x < sx; x++) {
       loc = x + sxy * z;
-      push_stack<T>(labels, loc, stack, placed_front);
+      push_stack<LABELS>(labels, loc, stack, placed_front);
       
       loc = x + sx * (sy - 1) + sxy * z;
-      push_stack<T>(labels, loc, stack, placed_back);
+      push_stack<LABELS>(labels, loc, stack, placed_back);
     }
   }
 
@@ -231,42 +367,312 @@ void initialize_stack(
   placed_back = false;
 
   for (size_t z = 0; z < sz; z++) {
+    placed_front = false;
+    placed_back = false;
     for (size_t y = 0; y < sy; y++) {
       loc = sx * y + sxy * z;
-      push_stack<T>(labels, loc, stack, placed_front);
+      push_stack<LABELS>(labels, loc, stack, placed_front);
 
       loc = (sx - 1) + sx * y + sxy * z;
-      push_stack<T>(labels, loc, stack, placed_back); 
+      push_stack<LABELS>(labels, loc, stack, placed_back); 
     }
   }
 }
 
-template <typename T>
-size_t binary_fill_holes2d(
-  T* labels, 
-  const size_t sx, const size_t sy
+/* Pushes a seed for each run of label found in the rows 
+ * neighboring the run [x0, x1) of row startx = (y, z).
+ * Row (dy, dz) is adjacent when |dy|, |dz| <= 1. 
+ * 26: all 8 neighboring rows, each widened by one 
+ *   voxel on each side for the diagonal steps along x.
+ * 18: all 8 rows, only the 4 face adjacent ones widened.
+ * 6 (or 4 in 2D, sz = 1): only the 4 face adjacent rows, 
+ *   not widened.
+ */
+template <typename LABELS>
+inline void push_neighbor_runs(
+  LABELS& labels, std::stack<size_t> &stack,
+  const size_t sx, const size_t sy, const size_t sz,
+  const size_t startx, const size_t y, const size_t z,
+  const size_t x0, const size_t x1,
+  const int connectivity, 
+  const uint8_t label = Label::BACKGROUND
 ) {
-  
-  const size_t voxels = sx * sy;
+  const size_t sxy = sx * sy;
 
-  if (voxels == 0) {
-    return 0;
+  for (int dz = -1; dz <= 1; dz++) {
+    if ((dz < 0 && z == 0) || (dz > 0 && z == sz - 1)) {
+      continue;
+    }
+    for (int dy = -1; dy <= 1; dy++) {
+      if ((dy == 0 && dz == 0) || (dy < 0 && y == 0) || (dy > 0 && y == sy - 1)) {
+        continue;
+      }
+
+      const bool edge = (dy != 0 && dz != 0);
+      if (edge && connectivity <= 6) {
+        continue;
+      }
+      const bool widen = (connectivity == 26) || (connectivity == 18 && !edge);
+
+      const size_t lo = (widen && x0 > 0) ? x0 - 1 : x0;
+      const size_t hi = (widen && x1 < sx) ? x1 + 1 : x1;
+      const size_t row = startx 
+        + static_cast<size_t>(static_cast<int64_t>(sx) * dy)
+        + static_cast<size_t>(static_cast<int64_t>(sxy) * dz);
+
+      bool placed = false;
+      for (size_t nx = lo; nx < hi; nx++) {
+        push_stack<LABELS>(labels, row + nx, stack, placed, label);
+      }
+    }
   }
+}
 
-  // mark all foreground as 2 (FOREGROUND) 
-  // so we can mark visited as 1 (VISITED_BACKGROUND) 
-  // without overwriting foreground as we want foreground 
-  // to be 2 and voids to be 0 (BACKGROUND)
-  for (size_t i = 0; i < voxels; i++) {
-    labels[i] = static_cast<T>(static_cast<uint8_t>(labels[i] != 0) * 2);
+/* initialize_stack with a per face policy (see Boundaries)
+ * for the first num_axes (2 or 3) axes followed by the 
+ * seed points and mask. Runs of seeds along each face 
+ * or mask row are pushed once as above. Each run outside 
+ * the domain seeds the background it touches under 
+ * connectivity like a visited run would.
+ */
+template <typename LABELS>
+void initialize_stack(
+    LABELS& labels, 
+    const size_t sx, const size_t sy, const size_t sz,
+    const int num_axes, const Boundaries& boundaries,
+    const int connectivity, std::stack<size_t> &stack
+  ) {
+  const size_t shape[3] = { sx, sy, sz };
+  const size_t strides[3] = { 1, sx, sx * sy };
+
+  for (int axis = 0; axis < num_axes; axis++) {
+    const int a0 = (axis == 0) ? 1 : 0;
+    const int a1 = (axis == 2) ? 1 : 2;
+
+    for (int side = 0; side < 2; side++) {
+      const int face = 2 * axis + side;
+      const FacePolicy policy = boundaries.faces[face];
+      if (policy == FacePolicy::CLOSED) {
+        continue;
+      }
+
+      const uint8_t* seeds = boundaries.seeds[face];
+      const size_t base = side * (shape[axis] - 1) * strides[axis];
+
+      size_t i = 0;
+      for (size_t v = 0; v < shape[a1]; v++) {
+        bool placed = false;
+        for (size_t u = 0; u < shape[a0]; u++, i++) {
+          if (policy == FacePolicy::SEEDED && !seeds[i]) {
+            placed = false;
+            continue;
+          }
+          push_stack<LABELS>(
+            labels, base + u * strides[a0] + v * strides[a1], 
+            stack, placed
+          );
+        }
+      }
+    }
+  }
+
+  for (size_t i = 0; i < boundaries.num_points; i++) {
+    const size_t loc = boundaries.points[i];
+    if (labels[loc] == Label::BACKGROUND) {
+      stack.push(loc);
+    }
+  }
+
+  const uint8_t* mask = boundaries.mask;
+  if (mask != nullptr) {
+    const size_t voxels = sx * sy * sz;
+    for (size_t row = 0; row < voxels; row += sx) {
+      bool placed = false;
+      for (size_t loc = row; loc < row + sx; loc++) {
+        if (!mask[loc]) {
+          placed = false;
+          continue;
+        }
+        push_stack<LABELS>(labels, loc, stack, placed);
+      }
+    }
+  }
+
+  const uint8_t* domain = boundaries.domain;
+  if (domain == nullptr) {
+    return;
+  }
+
+  for (size_t z = 0; z < sz; z++) {
+    for (size_t y = 0; y < sy; y++) {
+      const size_t startx = sx * (y + sy * z);
+      for (size_t x0 = 0; x0 < sx; x0++) {
+        if (domain[startx + x0]) {
+          continue;
+        }
+        size_t x1 = x0 + 1;
+        for (; x1 < sx && !domain[startx + x1]; x1++) {}
+
+        if (x0 > 0 && labels[startx + x0 - 1] == Label::BACKGROUND) {
+          stack.push(startx + x0 - 1);
+        }
+        if (x1 < sx && labels[startx + x1] == Label::BACKGROUND) {
+          stack.push(startx + x1);
+        }
+        push_neighbor_runs(
+          labels, stack, sx, sy, sz, 
+          startx, y, z, x0, x1, connectivity
+        );
+        x0 = x1;
+      }
+    }
   }
+}
+
+/* Scan line flood fill of the exterior background for 
+ * connectivities that include diagonals: 8 in 2D and 
+ * 18 or 26 in 3D (4 and 6 also work). Each popped seed 
+ * is grown into a whole run along x first. Then the 
+ * neighboring rows the run touches are scanned once 
+ * over the run's extent, widened by one voxel on each 
+ * side where a diagonal step along x is allowed, and 
+ * a seed is placed at the start of each background run 
+ * found there (see push_neighbor_runs). So like the face 
+ * connected flood, seeds are emitted per run rather 
+ * than per voxel.
+ */
+template <typename LABELS>
+size_t flood_exterior_runs(
+  LABELS& labels, 
+  const size_t sx, const size_t sy, const size_t sz,
+  std::stack<size_t> &stack,
+  const size_t num_background, const int connectivity
+) {
+  const size_t sxy = sx * sy;
 
   const libdivide::divider<size_t> fast_sx(sx); 
+  const libdivide::divider<size_t> fast_sxy(sxy); 
+
+  size_t num_visited = 0;
+
+  while (!stack.empty() && num_visited < num_background) {
+    size_t loc = stack.top();
+    stack.pop();
+
+    if (labels[loc]) {
+      continue;
+    }
+
+    const size_t z = loc / fast_sxy;
+    const size_t y = (loc - (z * sxy)) / fast_sx;
+    const size_t startx = y * sx + z * sxy;
+    const size_t x = loc - startx;
+
+    // grow the run [x0, x1) through loc
+    size_t x1 = x;
+    for (; x1 < sx && labels[startx + x1] == 0; x1++) {
+      visit(labels, startx + x1);
+    }
+    size_t x0 = x;
+    for (; x0 > 0 && labels[startx + x0 - 1] == 0; x0--) {
+      visit(labels, startx + x0 - 1);
+    }
+    num_visited += x1 - x0;
+
+    push_neighbor_runs(
+      labels, stack, sx, sy, sz, 
+      startx, y, z, x0, x1, connectivity
+    );
+  }
+
+  return num_visited;
+}
 
+template <typename LABELS>
+size_t flood_exterior_runs3d(
+  LABELS& labels, 
+  const size_t sx, const size_t sy, const size_t sz,
+  const size_t num_background, const int connectivity,
+  const Boundaries* boundaries = nullptr
+) {
   std::stack<size_t> stack; 
-  initialize_stack(labels, sx, sy, stack);
+  if (boundaries == nullptr) {
+    initialize_stack(labels, sx, sy, sz, stack);
+  }
+  else {
+    initialize_stack(labels, sx, sy, sz, 3, *boundaries, connectivity, stack);
+  }
+  return flood_exterior_runs(
+    labels, sx, sy, sz, stack, num_background, connectivity
+  );
+}
 
-  while (!stack.empty()) {
+// 8 connected 2D version. Seeds come from the four 
+// sides, a single slice is then flooded as 26 connected.
+template <typename LABELS>
+size_t flood_exterior_runs2d(
+  LABELS& labels, 
+  const size_t sx, const size_t sy,
+  const size_t num_background,
+  const Boundaries* boundaries = nullptr
+) {
+  std::stack<size_t> stack; 
+  if (boundaries == nullptr) {
+    initialize_stack(labels, sx, sy, stack);
+  }
+  else {
+    initialize_stack(labels, sx, sy, 1, 2, *boundaries, 26, stack);
+  }
+  return flood_exterior_runs(
+    labels, sx, sy, 1, stack, num_background, 26
+  );
+}
+
+/* Scan line flood fill of the exterior background 
+ * starting from the faces of the image. labels must
+ * already be marked as BACKGROUND or FOREGROUND. Visited
+ * background is marked VISITED_BACKGROUND.
+ *
+ * Returns the number of voxels visited. Once all
+ * num_background voxels have been visited there is 
+ * nothing left to find, so we stop early.
+ *
+ * connectivity is that of the background: 4 or 8 in 2D
+ * and 6, 18, or 26 in 3D. The face connected default 
+ * uses the neighbor flags below, the others use 
+ * flood_exterior_runs2d/3d. In 2D, 6 is treated as 4
+ * and 18 or 26 as 8 so a 3D setting can be passed 
+ * through for a single slice.
+ *
+ * boundaries, if not null, sets which faces seed the 
+ * flood and adds seeds inside the image (see Boundaries). 
+ * By default all faces do.
+ */
+template <typename LABELS>
+size_t flood_exterior2d(
+  LABELS& labels, 
+  const size_t sx, const size_t sy,
+  const size_t num_background,
+  const int connectivity = 4,
+  const Boundaries* boundaries = nullptr
+) {
+  if (connectivity > 6) {
+    return flood_exterior_runs2d(labels, sx, sy, num_background, boundaries);
+  }
+
+  const libdivide::divider<size_t> fast_sx(sx); 
+
+  std::stack<size_t> stack; 
+  if (boundaries == nullptr) {
+    initialize_stack(labels, sx, sy, stack);
+  }
+  else {
+    initialize_stack(labels, sx, sy, 1, 2, *boundaries, connectivity, stack);
+  }
+
+  size_t num_visited = 0;
+
+  while (!stack.empty() && num_visited < num_background) {
     size_t loc = stack.top();
     stack.pop();
 
@@ -280,74 +686,72 @@ size_t binary_fill_holes2d(
     bool yplus = true;
     bool yminus = true;
 
-    for (size_t cur = loc; cur < startx + sx; cur++) {
+    size_t cur = loc;
+    for (; cur < startx + sx; cur++) {
       if (labels[cur]) {
         break;
       }
-      labels[cur] = Label::VISITED_BACKGROUND;
-      add_neighbors<T>(
+      visit(labels, cur);
+      add_neighbors(
         labels, stack,
         sx, sy, 
         cur, y,
         yplus, yminus
       );
     }
+    num_visited += cur - loc;
 
     yplus = true;
     yminus = true;
 
     // avoid integer underflow
-    for (int64_t cur = static_cast<int64_t>(loc) - 1; cur >= static_cast<int64_t>(startx); cur--) {
-      if (labels[cur]) {
+    int64_t rcur = static_cast<int64_t>(loc) - 1;
+    for (; rcur >= static_cast<int64_t>(startx); rcur--) {
+      if (labels[rcur]) {
         break;
       }
-      labels[cur] = Label::VISITED_BACKGROUND;
-      add_neighbors<T>(
+      visit(labels, rcur);
+      add_neighbors(
         labels, stack,
         sx, sy,
-        cur, y,
+        rcur, y,
         yplus, yminus
       );
-    }    
-  }
-
-  size_t num_filled = 0;
-  for (size_t i = 0; i < voxels; i++) {
-    num_filled += static_cast<size_t>(labels[i] == Label::BACKGROUND);
-    labels[i] = static_cast<T>(labels[i] != Label::VISITED_BACKGROUND);
+    }
+    num_visited += static_cast<size_t>(static_cast<int64_t>(loc) - 1 - rcur);
   }
 
-  return num_filled;
+  return num_visited;
 }
 
-template <typename T>
-size_t binary_fill_holes3d(
-  T* labels, 
-  const size_t sx, const size_t sy, const size_t sz
+template <typename LABELS>
+size_t flood_exterior3d(
+  LABELS& labels, 
+  const size_t sx, const size_t sy, const size_t sz,
+  const size_t num_background,
+  const int connectivity = 6,
+  const Boundaries* boundaries = nullptr
 ) {
-
-  const size_t sxy = sx * sy;
-  const size_t voxels = sx * sy * sz;
-
-  if (voxels == 0) {
-    return 0;
+  if (connectivity > 6) {
+    return flood_exterior_runs3d(labels, sx, sy, sz, num_background, connectivity, boundaries);
   }
 
-  // mark all foreground as 2 (FOREGROUND) 
-  // so we can mark visited as 1 (VISITED_BACKGROUND) 
-  // without overwriting foreground as we want foreground 
-  // to be 2 and voids to be 0 (BACKGROUND)
-  for (size_t i = 0; i < voxels; i++) {
-    labels[i] = static_cast<T>(static_cast<uint8_t>(labels[i] != 0) * 2);
-  }
+  const size_t sxy = sx * sy;
 
   const libdivide::divider<size_t> fast_sx(sx); 
   const libdivide::divider<size_t> fast_sxy(sxy); 
 
   std::stack<size_t> stack; 
-  initialize_stack(labels, sx, sy, sz, stack);
+  if (boundaries == nullptr) {
+    initialize_stack(labels, sx, sy, sz, stack);
+  }
+  else {
+    initialize_stack(labels, sx, sy, sz, 3, *boundaries, connectivity, stack);
+  }
 
-  while (!stack.empty()) {
+  size_t num_visited = 0;
+
+  while (!stack.empty() && num_visited < num_background) {
     size_t loc = stack.top();
     stack.pop();
 
@@ -364,18 +768,20 @@ size_t binary_fill_holes3d(
     bool zplus = true;
     bool zminus = true;
 
-    for (size_t cur = loc; cur < startx + sx; cur++) {
+    size_t cur = loc;
+    for (; cur < startx + sx; cur++) {
       if (labels[cur]) {
         break;
       }
-      labels[cur] = Label::VISITED_BACKGROUND;
-      add_neighbors<T>(
+      visit(labels, cur);
+      add_neighbors(
         labels, stack,
         sx, sy, sz, 
         cur, y, z,
         yplus, yminus, zplus, zminus
       );
     }
+    num_visited += cur - loc;
 
     yplus = true;
     yminus = true;
@@ -383,43 +789,1567 @@ size_t binary_fill_holes3d(
     zminus = true;
 
     // avoid integer underflow
-    for (int64_t cur = static_cast<int64_t>(loc) - 1; cur >= static_cast<int64_t>(startx); cur--) {
-      if (labels[cur]) {
+    int64_t rcur = static_cast<int64_t>(loc) - 1;
+    for (; rcur >= static_cast<int64_t>(startx); rcur--) {
+      if (labels[rcur]) {
         break;
       }
-      labels[cur] = Label::VISITED_BACKGROUND;
-      add_neighbors<T>(
+      visit(labels, rcur);
+      add_neighbors(
         labels, stack,
         sx, sy, sz, 
-        cur, y, z,
+        rcur, y, z,
         yplus, yminus, zplus, zminus
       );
-    }    
+    }
+    num_visited += static_cast<size_t>(static_cast<int64_t>(loc) - 1 - rcur);
   }
 
-  size_t num_filled = 0;
+  return num_visited;
+}
+
+// mark all foreground as 2 (FOREGROUND) 
+// so we can mark visited as 1 (VISITED_BACKGROUND) 
+// without overwriting foreground as we want foreground 
+// to be 2 and voids to be 0 (BACKGROUND)
+// Returns the number of background voxels.
+template <typename T>
+size_t mark_foreground(T* labels, const size_t voxels) {
+  size_t num_background = 0;
   for (size_t i = 0; i < voxels; i++) {
-    num_filled += static_cast<size_t>(labels[i] == Label::BACKGROUND);
-    labels[i] = static_cast<T>(labels[i] != Label::VISITED_BACKGROUND);
+    num_background += static_cast<size_t>(labels[i] == 0);
+    labels[i] = static_cast<T>(static_cast<uint8_t>(labels[i] != 0) * 2);
   }
+  return num_background;
+}
 
-  return num_filled;
+// is_binary is set to whether every voxel is 0 or 1
+// which tells callers if the input could stand in for
+// the output when nothing is filled.
+template <typename T>
+size_t mark_foreground(
+  const T* labels, PackedLabels& packed, const size_t voxels,
+  bool &is_binary
+) {
+  size_t num_background = 0;
+  bool binary = true;
+  for (size_t i = 0; i < voxels; i++) {
+    if (labels[i] == 0) {
+      num_background++;
+    }
+    else {
+      binary = binary && (labels[i] == 1);
+      packed.set_foreground(i);
+    }
+  }
+  is_binary = binary;
+  return num_background;
 }
 
+// Same as above, but reads a strided view, e.g. a
+// bounding box inside of a larger volume, where voxel 
+// (x,y,z) is at labels[x * csx + y * csy + z * csz]. 
+// Strides are in elements and may be negative. packed
+// is filled in Fortran order of sx * sy * sz.
 template <typename T>
-size_t binary_fill_holes(
-  T* labels, 
-  const size_t sx, const size_t sy, const size_t sz
+size_t mark_foreground(
+  const T* labels, PackedLabels& packed,
+  const size_t sx, const size_t sy, const size_t sz,
+  const int64_t csx, const int64_t csy, const int64_t csz,
+  bool &is_binary
+) {
+  size_t num_background = 0;
+  bool binary = true;
+  size_t i = 0;
+  for (size_t z = 0; z < sz; z++) {
+    for (size_t y = 0; y < sy; y++) {
+      const T* row = labels + static_cast<int64_t>(y) * csy + static_cast<int64_t>(z) * csz;
+      for (size_t x = 0; x < sx; x++, i++) {
+        const T val = row[static_cast<int64_t>(x) * csx];
+        if (val == 0) {
+          num_background++;
+        }
+        else {
+          binary = binary && (val == 1);
+          packed.set_foreground(i);
+        }
+      }
+    }
+  }
+  is_binary = binary;
+  return num_background;
+}
+
+// Marks the n contiguous voxels of row, which start at 
+// voxel i of packed, where is_foreground(value) is true.
+// The predicate's 0 or 1 is shifted into place instead 
+// of branched on, and once i is byte aligned four voxels 
+// are combined into each byte, so the loop vectorizes.
+template <typename T, typename F>
+inline size_t mark_foreground_row_if(
+  const T* row, uint8_t* packed, size_t i, const size_t n,
+  const F& is_foreground
+) {
+  const uint8_t fg = static_cast<uint8_t>(Label::FOREGROUND);
+  size_t num_foreground = 0;
+  size_t x = 0;
+
+  for (; x < n && (i & 0x3); x++, i++) {
+    const uint8_t m = is_foreground(row[x]);
+    num_foreground += m;
+    packed[i >> 2] |= static_cast<uint8_t>((m * fg) << ((i & 0x3) << 1));
+  }
+
+  uint8_t* out = packed + (i >> 2);
+  const size_t num_bytes = (n - x) >> 2;
+  const T* vals = row + x;
+  for (size_t b = 0; b < num_bytes; b++, vals += 4) {
+    const uint8_t m0 = is_foreground(vals[0]);
+    const uint8_t m1 = is_foreground(vals[1]);
+    const uint8_t m2 = is_foreground(vals[2]);
+    const uint8_t m3 = is_foreground(vals[3]);
+    num_foreground += m0 + m1 + m2 + m3;
+    out[b] |= static_cast<uint8_t>(
+      (m0 * fg) | ((m1 * fg) << 2) | ((m2 * fg) << 4) | ((m3 * fg) << 6)
+    );
+  }
+  x += num_bytes << 2;
+  i += num_bytes << 2;
+
+  for (; x < n; x++, i++) {
+    const uint8_t m = is_foreground(row[x]);
+    num_foreground += m;
+    packed[i >> 2] |= static_cast<uint8_t>((m * fg) << ((i & 0x3) << 1));
+  }
+
+  return num_foreground;
+}
+
+// Same as mark_foreground, but voxels are foreground where
+// is_foreground(value) is true.
+template <typename T, typename F>
+size_t mark_foreground_if(
+  const T* labels, PackedLabels& packed,
+  const size_t sx, const size_t sy, const size_t sz,
+  const int64_t csx, const int64_t csy, const int64_t csz,
+  const F& is_foreground
 ) {
-  return binary_fill_holes3d<T>(labels, sx, sy, sz);
+  size_t num_foreground = 0;
+  size_t i = 0;
+  for (size_t z = 0; z < sz; z++) {
+    for (size_t y = 0; y < sy; y++) {
+      const T* row = labels + static_cast<int64_t>(y) * csy + static_cast<int64_t>(z) * csz;
+      if (csx == 1) {
+        num_foreground += mark_foreground_row_if(row, packed.data, i, sx, is_foreground);
+        i += sx;
+        continue;
+      }
+      for (size_t x = 0; x < sx; x++, i++) {
+        if (is_foreground(row[static_cast<int64_t>(x) * csx])) {
+          num_foreground++;
+          packed.set_foreground(i);
+        }
+      }
+    }
+  }
+  return sx * sy * sz - num_foreground;
 }
 
+// Marks the voxels picked by foreground, see Foreground.
+// The input never stands in for the output, so is_binary
+// is always false.
 template <typename T>
-size_t binary_fill_holes(
-  T* labels, 
-  const size_t sx, const size_t sy
+size_t mark_foreground(
+  const T* labels, PackedLabels& packed,
+  const size_t sx, const size_t sy, const size_t sz,
+  const int64_t csx, const int64_t csy, const int64_t csz,
+  const Foreground& foreground, bool &is_binary
+) {
+  is_binary = false;
+
+  const T* values = static_cast<const T*>(foreground.values);
+  const size_t num_values = foreground.num_values;
+
+  if (foreground.kind == ForegroundKind::EQUAL) {
+    const T value = values[0];
+    return mark_foreground_if(
+      labels, packed, sx, sy, sz, csx, csy, csz,
+      [value](const T val) { return val == value; }
+    );
+  }
+  else if (foreground.kind == ForegroundKind::ANY_OF) {
+    return mark_foreground_if(
+      labels, packed, sx, sy, sz, csx, csy, csz,
+      [values, num_values](const T val) { 
+        return std::binary_search(values, values + num_values, val);
+      }
+    );
+  }
+  else if (foreground.kind == ForegroundKind::IN_RANGE) {
+    const T lo = values[0];
+    const T hi = values[1];
+    if (lo <= hi) {
+      return mark_foreground_if(
+        labels, packed, sx, sy, sz, csx, csy, csz,
+        [lo, hi](const T val) { return lo <= val && val <= hi; }
+      );
+    }
+    return mark_foreground_if(
+      labels, packed, sx, sy, sz, csx, csy, csz,
+      [lo, hi](const T val) { return val >= lo || val <= hi; }
+    );
+  }
+
+  return mark_foreground(labels, packed, sx, sy, sz, csx, csy, csz, is_binary);
+}
+
+// Writes the image selected by mode as 0 or 1. 
+// out may be labels.
+template <typename LABELS, typename U>
+void write_output(
+  LABELS& labels, U* out, const size_t voxels,
+  const OutputMode mode = OutputMode::FILLED
+) {
+  if (mode == OutputMode::HOLES) {
+    for (size_t i = 0; i < voxels; i++) {
+      out[i] = static_cast<U>(labels[i] == Label::BACKGROUND);
+    }
+  }
+  else if (mode == OutputMode::EXTERIOR) {
+    for (size_t i = 0; i < voxels; i++) {
+      out[i] = static_cast<U>(labels[i] == Label::VISITED_BACKGROUND);
+    }
+  }
+  else {
+    for (size_t i = 0; i < voxels; i++) {
+      out[i] = static_cast<U>(labels[i] != Label::VISITED_BACKGROUND);
+    }
+  }
+}
+
+/* Packs the image selected by mode 8 voxels per byte
+ * using np.packbits (big endian) bit order. Voxels are 
+ * visited in Fortran order of an sx * sy * sz image whose 
+ * voxel (x,y,z) is found at x * csx + y * csy + z * csz 
+ * in labels, which lets a transposed flood be written 
+ * out in the original axis order.
+ */
+template <typename LABELS>
+void write_output_packed3d(
+  LABELS& labels, uint8_t* out,
+  const size_t sx, const size_t sy, const size_t sz,
+  const size_t csx, const size_t csy, const size_t csz,
+  const OutputMode mode = OutputMode::FILLED
+) {
+  // maps BACKGROUND, VISITED_BACKGROUND, FOREGROUND to 0 or 1
+  uint8_t lut[4] = { 1, 0, 1, 0 };
+  if (mode == OutputMode::HOLES) {
+    lut[0] = 1; lut[1] = 0; lut[2] = 0;
+  }
+  else if (mode == OutputMode::EXTERIOR) {
+    lut[0] = 0; lut[1] = 1; lut[2] = 0;
+  }
+
+  uint8_t byte = 0;
+  size_t i = 0;
+  for (size_t z = 0; z < sz; z++) {
+    for (size_t y = 0; y < sy; y++) {
+      const size_t row = y * csy + z * csz;
+      for (size_t x = 0; x < sx; x++, i++) {
+        byte = static_cast<uint8_t>((byte << 1) | lut[labels[row + x * csx]]);
+        if ((i & 0x7) == 0x7) {
+          out[i >> 3] = byte;
+          byte = 0;
+        }
+      }
+    }
+  }
+
+  if (i & 0x7) {
+    out[i >> 3] = static_cast<uint8_t>(byte << (8 - (i & 0x7)));
+  }
+}
+
+template <typename LABELS>
+void write_output_packed2d(
+  LABELS& labels, uint8_t* out,
+  const size_t sx, const size_t sy,
+  const size_t csx, const size_t csy,
+  const OutputMode mode = OutputMode::FILLED
 ) {
-  return binary_fill_holes2d<T>(labels, sx, sy);
+  write_output_packed3d(labels, out, sx, sy, 1, csx, csy, 0, mode);
+}
+
+template <typename T>
+size_t binary_fill_holes2d(
+  T* labels, 
+  const size_t sx, const size_t sy,
+  const OutputMode mode = OutputMode::FILLED,
+  const int connectivity = 4
+) {
+  
+  const size_t voxels = sx * sy;
+
+  if (voxels == 0) {
+    return 0;
+  }
+
+  const size_t num_background = mark_foreground(labels, voxels);
+  const size_t num_visited = flood_exterior2d(labels, sx, sy, num_background, connectivity);
+  write_output(labels, labels, voxels, mode);
+
+  return num_background - num_visited;
+}
+
+template <typename T>
+size_t binary_fill_holes3d(
+  T* labels, 
+  const size_t sx, const size_t sy, const size_t sz,
+  const OutputMode mode = OutputMode::FILLED,
+  const int connectivity = 6
+) {
+
+  const size_t voxels = sx * sy * sz;
+
+  if (voxels == 0) {
+    return 0;
+  }
+
+  const size_t num_background = mark_foreground(labels, voxels);
+  const size_t num_visited = flood_exterior3d(labels, sx, sy, sz, num_background, connectivity);
+  write_output(labels, labels, voxels, mode);
+
+  return num_background - num_visited;
+}
+
+template <typename T>
+size_t binary_fill_holes(
+  T* labels, 
+  const size_t sx, const size_t sy, const size_t sz,
+  const OutputMode mode = OutputMode::FILLED
+) {
+  return binary_fill_holes3d<T>(labels, sx, sy, sz, mode);
+}
+
+template <typename T>
+size_t binary_fill_holes(
+  T* labels, 
+  const size_t sx, const size_t sy,
+  const OutputMode mode = OutputMode::FILLED
+) {
+  return binary_fill_holes2d<T>(labels, sx, sy, mode);
+}
+
+/* Floods the exterior of a read-only image into 
+ * buffer, a zeroed PackedLabels::bytes(voxels) array 
+ * holding 2 bits per voxel, instead of into a copy of 
+ * the image. The result can be written out afterwards 
+ * with write_output_buffer once the caller knows whether 
+ * there is anything worth allocating an output for.
+ *
+ * Returns the number of voxels that would be filled.
+ */
+template <typename T>
+size_t flood_voids2d(
+  const T* labels, uint8_t* buffer,
+  const size_t sx, const size_t sy,
+  bool &is_binary, const int connectivity = 4
+) {
+  const size_t voxels = sx * sy;
+  PackedLabels packed(buffer);
+
+  const size_t num_background = mark_foreground(labels, packed, voxels, is_binary);
+  if (num_background == 0) {
+    return 0;
+  }
+
+  return num_background - flood_exterior2d(packed, sx, sy, num_background, connectivity);
+}
+
+template <typename T>
+size_t flood_voids3d(
+  const T* labels, uint8_t* buffer,
+  const size_t sx, const size_t sy, const size_t sz,
+  bool &is_binary, const int connectivity = 6
+) {
+  const size_t voxels = sx * sy * sz;
+  PackedLabels packed(buffer);
+
+  const size_t num_background = mark_foreground(labels, packed, voxels, is_binary);
+  if (num_background == 0) {
+    return 0;
+  }
+
+  return num_background - flood_exterior3d(packed, sx, sy, sz, num_background, connectivity);
+}
+
+// Marks the background outside of domain (see Boundaries)
+// as VISITED_BACKGROUND so the flood never enters it and
+// it's written out as exterior. Foreground stays as is.
+// Returns the number of background voxels marked.
+template <typename LABELS>
+size_t mark_outside_domain(
+  LABELS& labels, const size_t voxels, const uint8_t* domain
+) {
+  size_t num_marked = 0;
+  for (size_t loc = 0; loc < voxels; loc++) {
+    if (!domain[loc] && labels[loc] == Label::BACKGROUND) {
+      visit(labels, loc);
+      num_marked++;
+    }
+  }
+  return num_marked;
+}
+
+// Strided versions of the above for views that 
+// aren't contiguous. See mark_foreground. These also
+// take where to seed the exterior from, see Boundaries,
+// and which voxels are foreground, see Foreground.
+template <typename T>
+size_t flood_voids2d(
+  const T* labels, uint8_t* buffer,
+  const size_t sx, const size_t sy,
+  const int64_t csx, const int64_t csy,
+  bool &is_binary, const int connectivity = 4,
+  const Boundaries* boundaries = nullptr,
+  const Foreground* foreground = nullptr
+) {
+  PackedLabels packed(buffer);
+
+  size_t num_background = (foreground == nullptr)
+    ? mark_foreground(labels, packed, sx, sy, 1, csx, csy, 0, is_binary)
+    : mark_foreground(labels, packed, sx, sy, 1, csx, csy, 0, *foreground, is_binary);
+  if (boundaries != nullptr && boundaries->domain != nullptr) {
+    num_background -= mark_outside_domain(packed, sx * sy, boundaries->domain);
+  }
+  if (num_background == 0) {
+    return 0;
+  }
+
+  return num_background - flood_exterior2d(packed, sx, sy, num_background, connectivity, boundaries);
+}
+
+template <typename T>
+size_t flood_voids3d(
+  const T* labels, uint8_t* buffer,
+  const size_t sx, const size_t sy, const size_t sz,
+  const int64_t csx, const int64_t csy, const int64_t csz,
+  bool &is_binary, const int connectivity = 6,
+  const Boundaries* boundaries = nullptr,
+  const Foreground* foreground = nullptr
+) {
+  PackedLabels packed(buffer);
+
+  size_t num_background = (foreground == nullptr)
+    ? mark_foreground(labels, packed, sx, sy, sz, csx, csy, csz, is_binary)
+    : mark_foreground(labels, packed, sx, sy, sz, csx, csy, csz, *foreground, is_binary);
+  if (boundaries != nullptr && boundaries->domain != nullptr) {
+    num_background -= mark_outside_domain(packed, sx * sy * sz, boundaries->domain);
+  }
+  if (num_background == 0) {
+    return 0;
+  }
+
+  return num_background - flood_exterior3d(packed, sx, sy, sz, num_background, connectivity, boundaries);
+}
+
+// Size, bounding box, and centroid of one void.
+struct VoidStats {
+  size_t voxels;
+  size_t min_corner[3]; // bounding box (inclusive)
+  size_t max_corner[3];
+  double coord_sum[3]; // centroid = coord_sum / voxels
+};
+
+/* Floods the void containing seed, relabeling each
+ * voxel from label `from` to `to` using scan line runs
+ * with the background's connectivity (see 
+ * push_neighbor_runs). on_run(startx, y, z, x0, x1) is
+ * called for each run [x0, x1) of row startx = (y, z)
+ * once it has been relabeled.
+ *
+ * Returns: number of voxels relabeled
+ */
+template <typename LABELS, typename F>
+size_t flood_void_runs(
+  LABELS& labels, 
+  const size_t sx, const size_t sy, const size_t sz,
+  const size_t seed, const uint8_t from, const uint8_t to,
+  const int connectivity, const F& on_run
+) {
+  const size_t sxy = sx * sy;
+
+  const libdivide::divider<size_t> fast_sx(sx); 
+  const libdivide::divider<size_t> fast_sxy(sxy); 
+
+  std::stack<size_t> stack;
+  stack.push(seed);
+
+  size_t num_relabeled = 0;
+
+  while (!stack.empty()) {
+    size_t loc = stack.top();
+    stack.pop();
+
+    if (labels[loc] != from) {
+      continue;
+    }
+
+    const size_t z = loc / fast_sxy;
+    const size_t y = (loc - (z * sxy)) / fast_sx;
+    const size_t startx = y * sx + z * sxy;
+    const size_t x = loc - startx;
+
+    size_t x1 = x;
+    for (; x1 < sx && labels[startx + x1] == from; x1++) {
+      set_label(labels, startx + x1, to);
+    }
+    size_t x0 = x;
+    for (; x0 > 0 && labels[startx + x0 - 1] == from; x0--) {
+      set_label(labels, startx + x0 - 1, to);
+    }
+    num_relabeled += x1 - x0;
+
+    on_run(startx, y, z, x0, x1);
+
+    push_neighbor_runs(
+      labels, stack, sx, sy, sz, 
+      startx, y, z, x0, x1, connectivity, from
+    );
+  }
+
+  return num_relabeled;
+}
+
+/* flood_void_runs without a visitor. If stats is not 
+ * null, it receives the void's statistics, gathered 
+ * per run.
+ */
+template <typename LABELS>
+size_t flood_void(
+  LABELS& labels, 
+  const size_t sx, const size_t sy, const size_t sz,
+  const size_t seed, const uint8_t from, const uint8_t to,
+  const int connectivity, VoidStats* stats = nullptr
+) {
+  if (stats == nullptr) {
+    return flood_void_runs(
+      labels, sx, sy, sz, seed, from, to, connectivity,
+      [](size_t, size_t, size_t, size_t, size_t) {}
+    );
+  }
+
+  *stats = { 0, { sx, sy, sz }, { 0, 0, 0 }, { 0.0, 0.0, 0.0 } };
+
+  return flood_void_runs(
+    labels, sx, sy, sz, seed, from, to, connectivity,
+    [stats](size_t, size_t y, size_t z, size_t x0, size_t x1) {
+      const size_t run = x1 - x0;
+      stats->voxels += run;
+      stats->min_corner[0] = std::min(stats->min_corner[0], x0);
+      stats->min_corner[1] = std::min(stats->min_corner[1], y);
+      stats->min_corner[2] = std::min(stats->min_corner[2], z);
+      stats->max_corner[0] = std::max(stats->max_corner[0], x1 - 1);
+      stats->max_corner[1] = std::max(stats->max_corner[1], y);
+      stats->max_corner[2] = std::max(stats->max_corner[2], z);
+      stats->coord_sum[0] += 0.5 * static_cast<double>(x0 + x1 - 1) * static_cast<double>(run);
+      stats->coord_sum[1] += static_cast<double>(y) * static_cast<double>(run);
+      stats->coord_sum[2] += static_cast<double>(z) * static_cast<double>(run);
+    }
+  );
+}
+
+/* Keeps only the voids small enough to be filled.
+ * labels must already be flooded by flood_exterior2d/3d
+ * so that the num_voids unvisited BACKGROUND voxels are
+ * exactly the voids. Each void is flooded once to measure 
+ * it (marked MEASURED_VOID) and then once more to settle it:
+ * a void with more than max_size voxels or a bounding box 
+ * longer than max_extent_x, y, or z voxels along that axis 
+ * is relabeled VISITED_BACKGROUND, so it is left open and 
+ * written out as exterior, and the others are restored to 
+ * BACKGROUND. Pass SIZE_MAX for no limit.
+ *
+ * If stats is not null, the statistics of each kept void 
+ * are appended to it in raster order of the void's first 
+ * voxel, e.g. to list the holes without labeling them.
+ *
+ * Returns: number of voxels in the voids that are kept
+ */
+template <typename LABELS>
+size_t filter_voids(
+  LABELS& labels, 
+  const size_t sx, const size_t sy, const size_t sz,
+  const size_t num_voids, const size_t max_size,
+  const size_t max_extent_x, const size_t max_extent_y, const size_t max_extent_z,
+  const int connectivity = 6, std::vector<VoidStats>* stats = nullptr
+) {
+  if (num_voids == 0) {
+    return 0;
+  }
+  // nothing can exceed the limits
+  if (stats == nullptr && num_voids <= max_size 
+    && sx <= max_extent_x && sy <= max_extent_y && sz <= max_extent_z) {
+    return num_voids;
+  }
+
+  const size_t voxels = sx * sy * sz;
+  std::vector<size_t> kept;
+  size_t num_found = 0;
+  size_t num_kept = 0;
+  VoidStats void_stats;
+
+  for (size_t loc = 0; loc < voxels && num_found < num_voids; loc++) {
+    if (labels[loc] != Label::BACKGROUND) {
+      continue;
+    }
+
+    const size_t size = flood_void(
+      labels, sx, sy, sz, loc, 
+      Label::BACKGROUND, Label::MEASURED_VOID, 
+      connectivity, &void_stats
+    );
+    num_found += size;
+
+    const size_t* lo = void_stats.min_corner;
+    const size_t* hi = void_stats.max_corner;
+    if (
+      size > max_size
+      || hi[0] - lo[0] + 1 > max_extent_x
+      || hi[1] - lo[1] + 1 > max_extent_y
+      || hi[2] - lo[2] + 1 > max_extent_z
+    ) {
+      flood_void(
+        labels, sx, sy, sz, loc, 
+        Label::MEASURED_VOID, Label::VISITED_BACKGROUND, 
+        connectivity
+      );
+    }
+    else {
+      kept.push_back(loc);
+      num_kept += size;
+      if (stats != nullptr) {
+        stats->push_back(void_stats);
+      }
+    }
+  }
+
+  // done after the scan so kept voids aren't found twice
+  for (size_t seed : kept) {
+    flood_void(
+      labels, sx, sy, sz, seed, 
+      Label::MEASURED_VOID, Label::BACKGROUND, 
+      connectivity
+    );
+  }
+
+  return num_kept;
+}
+
+/* Applies filter_voids to a buffer flooded by 
+ * flood_voids2d/3d. num_voids is what they returned.
+ * Pass SIZE_MAX limits to only gather stats.
+ * In 2D, connectivity is 4 or 8 as for flood_exterior2d.
+ *
+ * Returns: number of voxels that will be filled
+ */
+inline size_t filter_voids2d(
+  uint8_t* buffer,
+  const size_t sx, const size_t sy,
+  const size_t num_voids, const size_t max_size,
+  const size_t max_extent_x, const size_t max_extent_y,
+  const int connectivity = 4, std::vector<VoidStats>* stats = nullptr
+) {
+  PackedLabels packed(buffer);
+  return filter_voids(
+    packed, sx, sy, 1, num_voids, max_size, 
+    max_extent_x, max_extent_y, SIZE_MAX,
+    (connectivity > 6) ? 26 : 4, stats
+  );
+}
+
+inline size_t filter_voids3d(
+  uint8_t* buffer,
+  const size_t sx, const size_t sy, const size_t sz,
+  const size_t num_voids, const size_t max_size,
+  const size_t max_extent_x, const size_t max_extent_y, const size_t max_extent_z,
+  const int connectivity = 6, std::vector<VoidStats>* stats = nullptr
+) {
+  PackedLabels packed(buffer);
+  return filter_voids(
+    packed, sx, sy, sz, num_voids, max_size, 
+    max_extent_x, max_extent_y, max_extent_z, 
+    connectivity, stats
+  );
+}
+
+// Writes the result of flood_voids2d/3d to out.
+template <typename U>
+void write_output_buffer(
+  uint8_t* buffer, U* out, const size_t voxels,
+  const OutputMode mode = OutputMode::FILLED
+) {
+  PackedLabels packed(buffer);
+  write_output(packed, out, voxels, mode);
+}
+
+// Writes the result of flood_voids2d/3d to a strided
+// view out where voxel (x,y,z) is at 
+// out[x * csx + y * csy + z * csz]. Use sz = 1 for 2D.
+template <typename U>
+void write_output_buffer(
+  uint8_t* buffer, U* out,
+  const size_t sx, const size_t sy, const size_t sz,
+  const int64_t csx, const int64_t csy, const int64_t csz,
+  const OutputMode mode = OutputMode::FILLED
+) {
+  PackedLabels packed(buffer);
+
+  // maps BACKGROUND, VISITED_BACKGROUND, FOREGROUND to 0 or 1
+  U lut[4] = { 1, 0, 1, 0 };
+  if (mode == OutputMode::HOLES) {
+    lut[0] = 1; lut[1] = 0; lut[2] = 0;
+  }
+  else if (mode == OutputMode::EXTERIOR) {
+    lut[0] = 0; lut[1] = 1; lut[2] = 0;
+  }
+
+  size_t i = 0;
+  for (size_t z = 0; z < sz; z++) {
+    for (size_t y = 0; y < sy; y++) {
+      U* row = out + static_cast<int64_t>(y) * csy + static_cast<int64_t>(z) * csz;
+      for (size_t x = 0; x < sx; x++, i++) {
+        row[static_cast<int64_t>(x) * csx] = lut[packed[i]];
+      }
+    }
+  }
+}
+
+// Packs the result of flood_voids2d/3d into out, which
+// must hold at least (sx * sy * sz + 7) / 8 bytes. 
+// See write_output_packed3d.
+inline void write_output_packed_buffer(
+  uint8_t* buffer, uint8_t* out,
+  const size_t sx, const size_t sy, const size_t sz,
+  const size_t csx, const size_t csy, const size_t csz,
+  const OutputMode mode = OutputMode::FILLED
+) {
+  PackedLabels packed(buffer);
+  write_output_packed3d(packed, out, sx, sy, sz, csx, csy, csz, mode);
+}
+
+// Writes fill_value into the voids found by flood_voids2d/3d 
+// and leaves every other voxel of out untouched.
+template <typename T>
+void write_fill_value_buffer(
+  uint8_t* buffer, T* out, const size_t voxels,
+  const T fill_value
+) {
+  const size_t num_bytes = PackedLabels::bytes(voxels);
+  for (size_t j = 0; j < num_bytes; j++) {
+    const uint8_t byte = buffer[j];
+    // every voxel in this byte is visited or foreground
+    if (((byte | (byte >> 1)) & 0x55) == 0x55) {
+      continue;
+    }
+    const size_t end = std::min(voxels, (j + 1) << 2);
+    for (size_t i = j << 2; i < end; i++) {
+      if (((byte >> ((i & 0x3) << 1)) & 0x3) == Label::BACKGROUND) {
+        out[i] = fill_value;
+      }
+    }
+  }
+}
+
+// Strided version of the above. See write_output_buffer.
+template <typename T>
+void write_fill_value_buffer(
+  uint8_t* buffer, T* out,
+  const size_t sx, const size_t sy, const size_t sz,
+  const int64_t csx, const int64_t csy, const int64_t csz,
+  const T fill_value
+) {
+  PackedLabels packed(buffer);
+
+  size_t i = 0;
+  for (size_t z = 0; z < sz; z++) {
+    for (size_t y = 0; y < sy; y++) {
+      T* row = out + static_cast<int64_t>(y) * csy + static_cast<int64_t>(z) * csz;
+      for (size_t x = 0; x < sx; x++, i++) {
+        if (packed[i] == Label::BACKGROUND) {
+          row[static_cast<int64_t>(x) * csx] = fill_value;
+        }
+      }
+    }
+  }
+}
+
+/* Fills voids with fill_value while leaving the
+ * foreground as it was, e.g. to close the holes of
+ * one label of a segmentation in place. The flood 
+ * runs in a 2 bit per voxel buffer.
+ *
+ * Returns the number of voxels filled in.
+ */
+template <typename T>
+size_t fill_holes_with_value2d(
+  T* labels, 
+  const size_t sx, const size_t sy,
+  const T fill_value, const int connectivity = 4
+) {
+  const size_t voxels = sx * sy;
+
+  if (voxels == 0) {
+    return 0;
+  }
+
+  std::vector<uint8_t> buffer(PackedLabels::bytes(voxels), 0);
+  bool is_binary = false;
+  const size_t num_filled = flood_voids2d(labels, buffer.data(), sx, sy, is_binary, connectivity);
+  if (num_filled > 0) {
+    write_fill_value_buffer(buffer.data(), labels, voxels, fill_value);
+  }
+  return num_filled;
+}
+
+template <typename T>
+size_t fill_holes_with_value3d(
+  T* labels, 
+  const size_t sx, const size_t sy, const size_t sz,
+  const T fill_value, const int connectivity = 6
+) {
+  const size_t voxels = sx * sy * sz;
+
+  if (voxels == 0) {
+    return 0;
+  }
+
+  std::vector<uint8_t> buffer(PackedLabels::bytes(voxels), 0);
+  bool is_binary = false;
+  const size_t num_filled = flood_voids3d(labels, buffer.data(), sx, sy, sz, is_binary, connectivity);
+  if (num_filled > 0) {
+    write_fill_value_buffer(buffer.data(), labels, voxels, fill_value);
+  }
+  return num_filled;
+}
+
+template <typename T>
+size_t fill_holes_with_value(
+  T* labels, 
+  const size_t sx, const size_t sy, const size_t sz,
+  const T fill_value
+) {
+  return fill_holes_with_value3d<T>(labels, sx, sy, sz, fill_value);
+}
+
+template <typename T>
+size_t fill_holes_with_value(
+  T* labels, 
+  const size_t sx, const size_t sy,
+  const T fill_value
+) {
+  return fill_holes_with_value2d<T>(labels, sx, sy, fill_value);
+}
+
+/* Looks for the labels around the void run [x0, x1) of 
+ * row (y, z): the voxels next to it under connectivity 
+ * (see push_neighbor_runs) that are FOREGROUND in packed.
+ * label is set by the first one found and conflict once
+ * a different label is seen.
+ */
+template <typename T>
+inline void enclosing_label(
+  const T* labels, const PackedLabels& packed,
+  const size_t sx, const size_t sy, const size_t sz,
+  const int64_t csx, const int64_t csy, const int64_t csz,
+  const size_t y, const size_t z, const size_t x0, const size_t x1,
+  const int connectivity, T& label, bool& found, bool& conflict
+) {
+  auto check = [&](const size_t nx, const size_t ny, const size_t nz) {
+    if (packed[nx + sx * (ny + sy * nz)] != Label::FOREGROUND) {
+      return;
+    }
+    const T val = labels[
+      static_cast<int64_t>(nx) * csx 
+      + static_cast<int64_t>(ny) * csy 
+      + static_cast<int64_t>(nz) * csz
+    ];
+    if (!found) {
+      label = val;
+      found = true;
+    }
+    else if (val != label) {
+      conflict = true;
+    }
+  };
+
+  if (x0 > 0) {
+    check(x0 - 1, y, z);
+  }
+  if (x1 < sx) {
+    check(x1, y, z);
+  }
+
+  for (int dz = -1; dz <= 1; dz++) {
+    if ((dz < 0 && z == 0) || (dz > 0 && z == sz - 1)) {
+      continue;
+    }
+    for (int dy = -1; dy <= 1; dy++) {
+      if ((dy == 0 && dz == 0) || (dy < 0 && y == 0) || (dy > 0 && y == sy - 1)) {
+        continue;
+      }
+
+      const bool edge = (dy != 0 && dz != 0);
+      if (edge && connectivity <= 6) {
+        continue;
+      }
+      const bool widen = (connectivity == 26) || (connectivity == 18 && !edge);
+
+      const size_t lo = (widen && x0 > 0) ? x0 - 1 : x0;
+      const size_t hi = (widen && x1 < sx) ? x1 + 1 : x1;
+      for (size_t nx = lo; nx < hi && !conflict; nx++) {
+        check(nx, y + dy, z + dz);
+      }
+    }
+  }
+}
+
+/* Writes the label enclosing each void of labels into it.
+ * packed must already be flooded by flood_exterior2d/3d 
+ * so that its num_voids unvisited BACKGROUND voxels are 
+ * exactly the voids. Each void is flooded once to find 
+ * the labels touching it and, if there is only one, once 
+ * more to write it. Voids touching several labels are 
+ * left as they are (marked MEASURED_VOID).
+ *
+ * Returns: number of voxels filled
+ */
+template <typename T>
+size_t fill_enclosed_voids(
+  T* labels, PackedLabels& packed,
+  const size_t sx, const size_t sy, const size_t sz,
+  const int64_t csx, const int64_t csy, const int64_t csz,
+  const size_t num_voids, const int connectivity
+) {
+  const size_t voxels = sx * sy * sz;
+  size_t num_found = 0;
+  size_t num_filled = 0;
+
+  for (size_t loc = 0; loc < voxels && num_found < num_voids; loc++) {
+    if (packed[loc] != Label::BACKGROUND) {
+      continue;
+    }
+
+    T label = 0;
+    bool found = false;
+    bool conflict = false;
+
+    num_found += flood_void_runs(
+      packed, sx, sy, sz, loc, 
+      Label::BACKGROUND, Label::MEASURED_VOID, connectivity,
+      [&](size_t, size_t y, size_t z, size_t x0, size_t x1) {
+        if (!conflict) {
+          enclosing_label(
+            labels, packed, sx, sy, sz, csx, csy, csz,
+            y, z, x0, x1, connectivity, label, found, conflict
+          );
+        }
+      }
+    );
+
+    if (!found || conflict) {
+      continue;
+    }
+
+    num_filled += flood_void_runs(
+      packed, sx, sy, sz, loc, 
+      Label::MEASURED_VOID, Label::FOREGROUND, connectivity,
+      [&](size_t, size_t y, size_t z, size_t x0, size_t x1) {
+        T* row = labels + static_cast<int64_t>(y) * csy + static_cast<int64_t>(z) * csz;
+        for (size_t x = x0; x < x1; x++) {
+          row[static_cast<int64_t>(x) * csx] = label;
+        }
+      }
+    );
+  }
+
+  return num_filled;
+}
+
+/* Fills the holes of every label of a segmentation in 
+ * one pass: each void (background, i.e. 0, that can't 
+ * reach the border) enclosed by a single label is 
+ * written with that label. Voids between several labels
+ * stay background and labels nested inside of another 
+ * are kept, unlike running fill_holes_with_value for 
+ * each label on its own. The exterior is 
+ * flooded once into a 2 bit per voxel buffer, then 
+ * only the voids are flooded again (see 
+ * fill_enclosed_voids).
+ *
+ * labels is read and written through element strides 
+ * as in mark_foreground. connectivity is that of the 
+ * background: 6, 18, or 26 (4 or 8 in 2D).
+ *
+ * Returns: number of voxels filled
+ */
+template <typename T>
+size_t fill_labels3d(
+  T* labels, 
+  const size_t sx, const size_t sy, const size_t sz,
+  const int64_t csx, const int64_t csy, const int64_t csz,
+  const int connectivity = 6
+) {
+  std::vector<uint8_t> buffer(PackedLabels::bytes(sx * sy * sz));
+  PackedLabels packed(buffer.data());
+
+  bool is_binary = false;
+  const size_t num_background = mark_foreground(
+    labels, packed, sx, sy, sz, csx, csy, csz, is_binary
+  );
+  if (num_background == 0) {
+    return 0;
+  }
+
+  const size_t num_voids = num_background - flood_exterior3d(
+    packed, sx, sy, sz, num_background, connectivity
+  );
+  return fill_enclosed_voids(
+    labels, packed, sx, sy, sz, csx, csy, csz, 
+    num_voids, connectivity
+  );
+}
+
+template <typename T>
+size_t fill_labels2d(
+  T* labels, 
+  const size_t sx, const size_t sy,
+  const int64_t csx, const int64_t csy,
+  const int connectivity = 4
+) {
+  std::vector<uint8_t> buffer(PackedLabels::bytes(sx * sy));
+  PackedLabels packed(buffer.data());
+
+  bool is_binary = false;
+  const size_t num_background = mark_foreground(
+    labels, packed, sx, sy, 1, csx, csy, 0, is_binary
+  );
+  if (num_background == 0) {
+    return 0;
+  }
+
+  const size_t num_voids = num_background - flood_exterior2d(
+    packed, sx, sy, num_background, connectivity
+  );
+  return fill_enclosed_voids(
+    labels, packed, sx, sy, 1, csx, csy, 0, 
+    num_voids, (connectivity > 6) ? 26 : 4
+  );
+}
+
+// Contiguous Fortran ordered versions of the above.
+template <typename T>
+size_t fill_labels3d(
+  T* labels, 
+  const size_t sx, const size_t sy, const size_t sz,
+  const int connectivity = 6
+) {
+  return fill_labels3d(labels, sx, sy, sz, 1, sx, sx * sy, connectivity);
+}
+
+template <typename T>
+size_t fill_labels2d(
+  T* labels, const size_t sx, const size_t sy,
+  const int connectivity = 4
+) {
+  return fill_labels2d(labels, sx, sy, 1, sx, connectivity);
+}
+
+// Counts the voxels that would be filled without 
+// writing to the image or allocating a copy of it.
+template <typename T>
+size_t count_voids2d(
+  const T* labels, 
+  const size_t sx, const size_t sy,
+  const int connectivity = 4
+) {
+  const size_t voxels = sx * sy;
+
+  if (voxels == 0) {
+    return 0;
+  }
+
+  std::vector<uint8_t> buffer(PackedLabels::bytes(voxels), 0);
+  bool is_binary = false;
+  return flood_voids2d(labels, buffer.data(), sx, sy, is_binary, connectivity);
+}
+
+template <typename T>
+size_t count_voids3d(
+  const T* labels, 
+  const size_t sx, const size_t sy, const size_t sz,
+  const int connectivity = 6
+) {
+  const size_t voxels = sx * sy * sz;
+
+  if (voxels == 0) {
+    return 0;
+  }
+
+  std::vector<uint8_t> buffer(PackedLabels::bytes(voxels), 0);
+  bool is_binary = false;
+  return flood_voids3d(labels, buffer.data(), sx, sy, sz, is_binary, connectivity);
+}
+
+template <typename T>
+size_t count_voids(
+  const T* labels, 
+  const size_t sx, const size_t sy, const size_t sz
+) {
+  return count_voids3d<T>(labels, sx, sy, sz);
+}
+
+template <typename T>
+size_t count_voids(
+  const T* labels, 
+  const size_t sx, const size_t sy
+) {
+  return count_voids2d<T>(labels, sx, sy);
+}
+
+// The flood stops as soon as every background 
+// voxel has been reached, so this is an early exit.
+template <typename T>
+bool has_holes(
+  const T* labels, 
+  const size_t sx, const size_t sy, const size_t sz
+) {
+  return count_voids3d<T>(labels, sx, sy, sz) > 0;
+}
+
+template <typename T>
+bool has_holes(
+  const T* labels, 
+  const size_t sx, const size_t sy
+) {
+  return count_voids2d<T>(labels, sx, sy) > 0;
+}
+
+/* Runs worker on a pool of threads (0 = one per 
+ * core, capped at max_threads) that includes the 
+ * calling thread. Workers are expected to pull their 
+ * own work items, e.g. from an atomic counter. The 
+ * first exception thrown by any worker is rethrown 
+ * once all threads have finished.
+ */
+template <typename F>
+void run_workers(size_t threads, const size_t max_threads, F worker) {
+  if (threads == 0) {
+    threads = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  threads = std::max(std::min(threads, max_threads), static_cast<size_t>(1));
+
+  std::exception_ptr error = nullptr;
+  std::mutex error_mutex;
+
+  auto guarded = [&]() {
+    try {
+      worker();
+    }
+    catch (...) {
+      std::lock_guard<std::mutex> lock(error_mutex);
+      if (!error) {
+        error = std::current_exception();
+      }
+    }
+  };
+
+  std::vector<std::thread> pool;
+  for (size_t t = 1; t < threads; t++) {
+    pool.emplace_back(guarded);
+  }
+  guarded();
+  for (std::thread &thread : pool) {
+    thread.join();
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+/* Fills every 2D slice of a 3D volume along axis 
+ * (0, 1, or 2) independently and writes the result 
+ * to out, which may be labels. Both are strided 
+ * views (see mark_foreground) so slices along any 
+ * axis are read and written without being copied. 
+ * Slices are handed out to a pool of threads 
+ * (0 = one per core), each with its own 2 bit per 
+ * pixel buffer. If counts is not null, it receives 
+ * the number of voxels filled in each slice.
+ * connectivity is 4 or 8 within each slice.
+ *
+ * Returns: total number of voxels filled in
+ */
+template <typename T, typename U>
+size_t binary_fill_holes_slices(
+  const T* labels, U* out,
+  const size_t sx, const size_t sy, const size_t sz,
+  const int64_t csx, const int64_t csy, const int64_t csz,
+  const int64_t osx, const int64_t osy, const int64_t osz,
+  const int axis, size_t* counts = nullptr, 
+  size_t threads = 0, const OutputMode mode = OutputMode::FILLED,
+  const int connectivity = 4
+) {
+  const size_t shape[3] = { sx, sy, sz };
+  const int64_t strides[3] = { csx, csy, csz };
+  const int64_t out_strides[3] = { osx, osy, osz };
+
+  const int a0 = (axis == 0) ? 1 : 0;
+  const int a1 = (axis == 2) ? 1 : 2;
+  const size_t num_slices = shape[axis];
+  const size_t s0 = shape[a0];
+  const size_t s1 = shape[a1];
+
+  std::atomic<size_t> next(0);
+  std::atomic<size_t> total(0);
+
+  run_workers(threads, num_slices, [&]() {
+    std::vector<uint8_t> buffer(PackedLabels::bytes(s0 * s1));
+    bool is_binary = false;
+    size_t k;
+    while ((k = next++) < num_slices) {
+      std::fill(buffer.begin(), buffer.end(), 0);
+      const size_t num_filled = flood_voids2d<T>(
+        labels + static_cast<int64_t>(k) * strides[axis], buffer.data(),
+        s0, s1, strides[a0], strides[a1], is_binary, connectivity
+      );
+      write_output_buffer<U>(
+        buffer.data(), out + static_cast<int64_t>(k) * out_strides[axis],
+        s0, s1, 1, out_strides[a0], out_strides[a1], 0, mode
+      );
+      if (counts != nullptr) {
+        counts[k] = num_filled;
+      }
+      total += num_filled;
+    }
+  });
+
+  return total;
+}
+
+/* Fills a batch of independent sx * sy * sz volumes 
+ * of ndim 2 (sz = 1) or 3 (sz may also be 1) that share 
+ * a shape and strides, e.g. the time points of an 
+ * (x, y, z, t) array. Volume v 
+ * starts at labels + offsets[v] and out + out_offsets[v] 
+ * (in elements) and both are strided views, see 
+ * mark_foreground, so out may be labels. Volumes are 
+ * handed out to a pool of threads (0 = one per core), 
+ * each with its own 2 bit per voxel buffer. If counts 
+ * is not null, it receives the number of voxels filled 
+ * in each volume. connectivity is 6, 18, or 26 (see 
+ * flood_exterior2d for 2D volumes).
+ *
+ * Returns: total number of voxels filled in
+ */
+template <typename T, typename U>
+size_t binary_fill_holes_batch(
+  const T* labels, U* out,
+  const size_t sx, const size_t sy, const size_t sz, const int ndim,
+  const int64_t csx, const int64_t csy, const int64_t csz,
+  const int64_t osx, const int64_t osy, const int64_t osz,
+  const int64_t* offsets, const int64_t* out_offsets, 
+  const size_t num_volumes, size_t* counts = nullptr,
+  size_t threads = 0, const OutputMode mode = OutputMode::FILLED,
+  const int connectivity = 6
+) {
+  std::atomic<size_t> next(0);
+  std::atomic<size_t> total(0);
+
+  run_workers(threads, num_volumes, [&]() {
+    std::vector<uint8_t> buffer(PackedLabels::bytes(sx * sy * sz));
+    bool is_binary = false;
+    size_t v;
+    while ((v = next++) < num_volumes) {
+      std::fill(buffer.begin(), buffer.end(), 0);
+      size_t num_filled = 0;
+      if (ndim == 2) {
+        num_filled = flood_voids2d<T>(
+          labels + offsets[v], buffer.data(), sx, sy, csx, csy, 
+          is_binary, connectivity
+        );
+      }
+      else {
+        num_filled = flood_voids3d<T>(
+          labels + offsets[v], buffer.data(), 
+          sx, sy, sz, csx, csy, csz, is_binary, connectivity
+        );
+      }
+      write_output_buffer<U>(
+        buffer.data(), out + out_offsets[v], 
+        sx, sy, sz, osx, osy, osz, mode
+      );
+      if (counts != nullptr) {
+        counts[v] = num_filled;
+      }
+      total += num_filled;
+    }
+  });
+
+  return total;
+}
+
+// How binary_fill_holes_2p5d combines its three per axis fills. 
+// A background voxel is filled when it is in a hole
+// of at least 1 (UNION), 2 (VOTE), or 3 (INTERSECTION)
+// of the x, y, and z slices through it.
+enum Combine {
+  UNION = 1,
+  VOTE = 2,
+  INTERSECTION = 3
+};
+
+/* 2.5D fill: fills the 2D slices of a 3D image along 
+ * each of x, y, and z and combines the three results
+ * per voxel (see Combine). labels is a strided view 
+ * (see mark_foreground) and out is a separate Fortran 
+ * ordered sx * sy * sz image. The x, y, and z passes 
+ * run one after another, each adding its votes to out, 
+ * and a final pass writes 0 or 1, so no per axis 
+ * temporaries are needed.
+ *
+ * Within a pass, slices are filled in parallel on a
+ * pool of threads (0 = one per core). x slices (yz 
+ * planes) are handled in blocks of consecutive slices 
+ * (up to 1 MiB of scratch per thread) that are read 
+ * and written together so that each cache line is 
+ * touched once per block rather than once per slice. 
+ * y and z slices are already read and written along 
+ * contiguous x rows.
+ *
+ * Returns: number of voxels filled in
+ */
+template <typename T, typename U>
+size_t binary_fill_holes_2p5d(
+  const T* labels, U* out,
+  const size_t sx, const size_t sy, const size_t sz,
+  const int64_t csx, const int64_t csy, const int64_t csz,
+  const Combine combine = Combine::UNION, size_t threads = 0
+) {
+  std::fill(out, out + sx * sy * sz, 0);
+
+  // a block spans a cache line of x but its per thread
+  // scratch is capped so big yz planes aren't buffered 
+  // 64 at a time, at least one plane is always used
+  const size_t max_block_bytes = 1 << 20;
+  const size_t plane_bytes = PackedLabels::bytes(sy * sz);
+  const size_t block = std::max(
+    std::min(64 / sizeof(T), max_block_bytes / std::max(plane_bytes, static_cast<size_t>(1))),
+    static_cast<size_t>(1)
+  );
+  const size_t num_blocks = (sx + block - 1) / block;
+
+  std::atomic<size_t> next_block(0);
+  run_workers(threads, num_blocks, [&]() {
+    std::vector<uint8_t> buffer(plane_bytes * block);
+    std::vector<size_t> num_background(block);
+    std::vector<PackedLabels> planes;
+    for (size_t bx = 0; bx < block; bx++) {
+      planes.push_back(PackedLabels(buffer.data() + bx * plane_bytes));
+    }
+
+    size_t b;
+    while ((b = next_block++) < num_blocks) {
+      const size_t x0 = b * block;
+      const size_t width = std::min(block, sx - x0);
+      std::fill(buffer.begin(), buffer.end(), 0);
+      std::fill(num_background.begin(), num_background.end(), 0);
+
+      size_t i = 0;
+      for (size_t z = 0; z < sz; z++) {
+        for (size_t y = 0; y < sy; y++, i++) {
+          const T* row = labels + static_cast<int64_t>(x0) * csx 
+            + static_cast<int64_t>(y) * csy + static_cast<int64_t>(z) * csz;
+          for (size_t bx = 0; bx < width; bx++) {
+            if (row[static_cast<int64_t>(bx) * csx] == 0) {
+              num_background[bx]++;
+            }
+            else {
+              planes[bx].set_foreground(i);
+            }
+          }
+        }
+      }
+
+      for (size_t bx = 0; bx < width; bx++) {
+        if (num_background[bx] > 0) {
+          flood_exterior2d(planes[bx], sy, sz, num_background[bx]);
+        }
+      }
+
+      i = 0;
+      for (size_t z = 0; z < sz; z++) {
+        for (size_t y = 0; y < sy; y++, i++) {
+          U* row = out + x0 + sx * (y + sy * z);
+          for (size_t bx = 0; bx < width; bx++) {
+            row[bx] += (planes[bx][i] == Label::BACKGROUND);
+          }
+        }
+      }
+    }
+  });
+
+  // y slices are xz planes, z slices are xy planes
+  for (int axis = 1; axis < 3; axis++) {
+    const size_t num_slices = (axis == 1) ? sy : sz;
+    const size_t s1 = (axis == 1) ? sz : sy;
+    const int64_t c1 = (axis == 1) ? csz : csy;
+    const int64_t ck = (axis == 1) ? csy : csz;
+    const size_t o1 = (axis == 1) ? sx * sy : sx;
+    const size_t ok = (axis == 1) ? sx : sx * sy;
+
+    std::atomic<size_t> next_slice(0);
+    run_workers(threads, num_slices, [&]() {
+      std::vector<uint8_t> buffer(PackedLabels::bytes(sx * s1));
+      PackedLabels packed(buffer.data());
+      bool is_binary = false;
+
+      size_t k;
+      while ((k = next_slice++) < num_slices) {
+        std::fill(buffer.begin(), buffer.end(), 0);
+        flood_voids2d<T>(
+          labels + static_cast<int64_t>(k) * ck, buffer.data(),
+          sx, s1, csx, c1, is_binary
+        );
+        size_t i = 0;
+        for (size_t j = 0; j < s1; j++) {
+          U* row = out + k * ok + j * o1;
+          for (size_t x = 0; x < sx; x++, i++) {
+            row[x] += (packed[i] == Label::BACKGROUND);
+          }
+        }
+      }
+    });
+  }
+
+  const U threshold = static_cast<U>(combine);
+  std::atomic<size_t> next_z(0);
+  std::atomic<size_t> num_filled(0);
+  run_workers(threads, sz, [&]() {
+    size_t z;
+    while ((z = next_z++) < sz) {
+      size_t filled = 0;
+      for (size_t y = 0; y < sy; y++) {
+        const T* row = labels + static_cast<int64_t>(y) * csy + static_cast<int64_t>(z) * csz;
+        U* out_row = out + sx * (y + sy * z);
+        for (size_t x = 0; x < sx; x++) {
+          if (row[static_cast<int64_t>(x) * csx] != 0) {
+            out_row[x] = 1;
+          }
+          else if (out_row[x] >= threshold) {
+            out_row[x] = 1;
+            filled++;
+          }
+          else {
+            out_row[x] = 0;
+          }
+        }
+      }
+      num_filled += filled;
+    }
+  });
+
+  return num_filled;
+}
+
+// Element type of a FillTask's labels. Signed 
+// integers and bool use the unsigned type of the
+// same width as only zero vs. non-zero matters.
+enum DataType {
+  UINT8 = 0,
+  UINT16 = 1,
+  UINT32 = 2,
+  UINT64 = 3,
+  FLOAT32 = 4,
+  FLOAT64 = 5
+};
+
+// One image for binary_fill_holes_many. labels is a 
+// Fortran ordered sx * sy * sz image (sz = 1 for 2D) 
+// that is filled in place. num_filled is the output.
+struct FillTask {
+  void* labels;
+  DataType dtype;
+  size_t sx;
+  size_t sy;
+  size_t sz;
+  int ndim; // 2 or 3, a 3D image may have sz == 1
+  OutputMode mode;
+  int connectivity; // 6, 18, or 26, or 4 or 8 in 2D
+  size_t num_filled;
+};
+
+template <typename T>
+size_t run_fill_task(FillTask &task) {
+  T* labels = static_cast<T*>(task.labels);
+  if (task.ndim == 2) {
+    return binary_fill_holes2d<T>(labels, task.sx, task.sy, task.mode, task.connectivity);
+  }
+  return binary_fill_holes3d<T>(labels, task.sx, task.sy, task.sz, task.mode, task.connectivity);
+}
+
+inline void run_fill_task(FillTask &task) {
+  switch (task.dtype) {
+    case DataType::UINT8: 
+      task.num_filled = run_fill_task<uint8_t>(task);
+      break;
+    case DataType::UINT16: 
+      task.num_filled = run_fill_task<uint16_t>(task);
+      break;
+    case DataType::UINT32: 
+      task.num_filled = run_fill_task<uint32_t>(task);
+      break;
+    case DataType::UINT64: 
+      task.num_filled = run_fill_task<uint64_t>(task);
+      break;
+    case DataType::FLOAT32: 
+      task.num_filled = run_fill_task<float>(task);
+      break;
+    case DataType::FLOAT64: 
+      task.num_filled = run_fill_task<double>(task);
+      break;
+  }
+}
+
+/* Fills many independent images concurrently using 
+ * a pool of threads (0 = one per core). Tasks are 
+ * handed out largest first so that a big image 
+ * started last doesn't leave the other threads idle 
+ * waiting on it. See run_workers for exceptions.
+ */
+inline void binary_fill_holes_many(
+  std::vector<FillTask> &tasks, size_t threads = 0
+) {
+  std::vector<size_t> order(tasks.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), 
+    [&tasks](const size_t a, const size_t b) {
+      return tasks[a].sx * tasks[a].sy * tasks[a].sz 
+        > tasks[b].sx * tasks[b].sy * tasks[b].sz;
+    }
+  );
+
+  std::atomic<size_t> next(0);
+
+  run_workers(threads, tasks.size(), [&]() {
+    size_t i;
+    while ((i = next++) < order.size()) {
+      run_fill_task(tasks[order[i]]);
+    }
+  });
 }
 
 };
@@ -1,10 +1,26 @@
 import typing
-from typing import Literal, Union, overload
+from typing import Iterable, Literal, Protocol, TypedDict, Union, overload
 
 import numpy as np
-from numpy.typing import NDArray
+from numpy.typing import DTypeLike, NDArray
 
 _T = typing.TypeVar("_T", bound=np.generic)
+_OutputMode = Literal["filled", "holes", "exterior"]
+_Connectivity = Union[Literal[4, 8, 6, 18, 26], None]
+_HoleExtent = Union[int, tuple[Union[int, None], ...], None]
+_Boundary = Union[str, typing.Sequence[Union[str, NDArray[typing.Any]]], None]
+_Seeds = Union[NDArray[typing.Any], typing.Sequence[typing.Sequence[int]], None]
+_ForegroundIds = Union[int, float, typing.Sequence[Union[int, float]], NDArray[typing.Any], None]
+
+class _HolesStatistics(TypedDict):
+    voxel_counts: NDArray[np.uint64]
+    bounding_boxes: list[tuple[slice, ...]]
+    centroids: NDArray[np.float64]
+
+class _SupportsDLPack(Protocol):
+    def __dlpack__(self, *args: typing.Any, **kwargs: typing.Any) -> typing.Any: ...
+
+_ArrayInput = Union[NDArray[typing.Any], _SupportsDLPack, memoryview]
 
 class DimensionError(Exception): ...
 
@@ -14,12 +30,40 @@ def fill(
     in_place: bool = False,
     *,
     return_fill_count: Literal[False] = False,
+    output: _OutputMode = "filled",
+    output_format: Literal["array"] = "array",
+    out_dtype: None = None,
+    fill_value: Union[int, float, None] = None,
+    out: None = None,
+    connectivity: _Connectivity = None,
+    max_hole_size: Union[int, None] = None,
+    max_hole_extent: _HoleExtent = None,
+    return_holes: Literal[False] = False,
+    boundary: _Boundary = None,
+    seeds: _Seeds = None,
+    domain: Union[NDArray[typing.Any], None] = None,
+    foreground: None = None,
+    threshold: None = None,
 ) -> NDArray[_T]: ...
 @overload
 def fill(
     labels: NDArray[_T],
     in_place: bool,
     return_fill_count: Literal[False] = False,
+    output: _OutputMode = "filled",
+    output_format: Literal["array"] = "array",
+    out_dtype: None = None,
+    fill_value: Union[int, float, None] = None,
+    out: None = None,
+    connectivity: _Connectivity = None,
+    max_hole_size: Union[int, None] = None,
+    max_hole_extent: _HoleExtent = None,
+    return_holes: Literal[False] = False,
+    boundary: _Boundary = None,
+    seeds: _Seeds = None,
+    domain: Union[NDArray[typing.Any], None] = None,
+    foreground: None = None,
+    threshold: None = None,
 ) -> NDArray[_T]: ...
 @overload
 def fill(
@@ -27,27 +71,677 @@ def fill(
     in_place: bool = False,
     *,
     return_fill_count: Literal[True],
+    output: _OutputMode = "filled",
+    output_format: Literal["array"] = "array",
+    out_dtype: None = None,
+    fill_value: Union[int, float, None] = None,
+    out: None = None,
+    connectivity: _Connectivity = None,
+    max_hole_size: Union[int, None] = None,
+    max_hole_extent: _HoleExtent = None,
+    return_holes: Literal[False] = False,
+    boundary: _Boundary = None,
+    seeds: _Seeds = None,
+    domain: Union[NDArray[typing.Any], None] = None,
+    foreground: None = None,
+    threshold: None = None,
 ) -> tuple[NDArray[_T], int]: ...
 @overload
 def fill(
     labels: NDArray[_T],
     in_place: bool,
     return_fill_count: Literal[True],
+    output: _OutputMode = "filled",
+    output_format: Literal["array"] = "array",
+    out_dtype: None = None,
+    fill_value: Union[int, float, None] = None,
+    out: None = None,
+    connectivity: _Connectivity = None,
+    max_hole_size: Union[int, None] = None,
+    max_hole_extent: _HoleExtent = None,
+    return_holes: Literal[False] = False,
+    boundary: _Boundary = None,
+    seeds: _Seeds = None,
+    domain: Union[NDArray[typing.Any], None] = None,
+    foreground: None = None,
+    threshold: None = None,
+) -> tuple[NDArray[_T], int]: ...
+@overload
+def fill(
+    labels: NDArray[typing.Any],
+    in_place: bool = False,
+    *,
+    return_fill_count: Literal[False] = False,
+    output: _OutputMode = "filled",
+    output_format: Literal["packed"],
+    connectivity: _Connectivity = None,
+    max_hole_size: Union[int, None] = None,
+    max_hole_extent: _HoleExtent = None,
+    return_holes: Literal[False] = False,
+    boundary: _Boundary = None,
+    seeds: _Seeds = None,
+    domain: Union[NDArray[typing.Any], None] = None,
+    foreground: None = None,
+    threshold: None = None,
+) -> NDArray[np.uint8]: ...
+@overload
+def fill(
+    labels: NDArray[typing.Any],
+    in_place: bool = False,
+    *,
+    return_fill_count: Literal[False] = False,
+    output: _OutputMode = "filled",
+    out: NDArray[_T],
+    connectivity: _Connectivity = None,
+    max_hole_size: Union[int, None] = None,
+    max_hole_extent: _HoleExtent = None,
+    return_holes: Literal[False] = False,
+    boundary: _Boundary = None,
+    seeds: _Seeds = None,
+    domain: Union[NDArray[typing.Any], None] = None,
+    foreground: None = None,
+    threshold: None = None,
+) -> NDArray[_T]: ...
+@overload
+def fill(
+    labels: NDArray[typing.Any],
+    in_place: bool = False,
+    *,
+    return_fill_count: Literal[True],
+    output: _OutputMode = "filled",
+    out: NDArray[_T],
+    connectivity: _Connectivity = None,
+    max_hole_size: Union[int, None] = None,
+    max_hole_extent: _HoleExtent = None,
+    return_holes: Literal[False] = False,
+    boundary: _Boundary = None,
+    seeds: _Seeds = None,
+    domain: Union[NDArray[typing.Any], None] = None,
+    foreground: None = None,
+    threshold: None = None,
 ) -> tuple[NDArray[_T], int]: ...
+@overload
+def fill(
+    labels: NDArray[typing.Any],
+    in_place: bool = False,
+    *,
+    return_fill_count: Literal[True],
+    output: _OutputMode = "filled",
+    output_format: Literal["packed"],
+    connectivity: _Connectivity = None,
+    max_hole_size: Union[int, None] = None,
+    max_hole_extent: _HoleExtent = None,
+    return_holes: Literal[False] = False,
+    boundary: _Boundary = None,
+    seeds: _Seeds = None,
+    domain: Union[NDArray[typing.Any], None] = None,
+    foreground: None = None,
+    threshold: None = None,
+) -> tuple[NDArray[np.uint8], int]: ...
+@overload
+def fill(
+    labels: NDArray[typing.Any],
+    in_place: bool = False,
+    *,
+    return_fill_count: Literal[False] = False,
+    output: _OutputMode = "filled",
+    output_format: Literal["array"] = "array",
+    out_dtype: DTypeLike,
+    connectivity: _Connectivity = None,
+    max_hole_size: Union[int, None] = None,
+    max_hole_extent: _HoleExtent = None,
+    return_holes: Literal[False] = False,
+    boundary: _Boundary = None,
+    seeds: _Seeds = None,
+    domain: Union[NDArray[typing.Any], None] = None,
+    foreground: None = None,
+    threshold: None = None,
+) -> NDArray[typing.Any]: ...
+@overload
+def fill(
+    labels: NDArray[typing.Any],
+    in_place: bool = False,
+    *,
+    return_fill_count: Literal[True],
+    output: _OutputMode = "filled",
+    output_format: Literal["array"] = "array",
+    out_dtype: DTypeLike,
+    connectivity: _Connectivity = None,
+    max_hole_size: Union[int, None] = None,
+    max_hole_extent: _HoleExtent = None,
+    return_holes: Literal[False] = False,
+    boundary: _Boundary = None,
+    seeds: _Seeds = None,
+    domain: Union[NDArray[typing.Any], None] = None,
+    foreground: None = None,
+    threshold: None = None,
+) -> tuple[NDArray[typing.Any], int]: ...
+@overload
+def fill(
+    labels: NDArray[_T],
+    in_place: bool = False,
+    *,
+    return_fill_count: Literal[False] = False,
+    output: _OutputMode = "filled",
+    batch_axes: Union[int, tuple[int, ...]],
+    threads: int = 0,
+    connectivity: _Connectivity = None,
+) -> NDArray[_T]: ...
+@overload
+def fill(
+    labels: NDArray[_T],
+    in_place: bool = False,
+    *,
+    return_fill_count: Literal[True],
+    output: _OutputMode = "filled",
+    batch_axes: Union[int, tuple[int, ...]],
+    threads: int = 0,
+    connectivity: _Connectivity = None,
+) -> tuple[NDArray[_T], NDArray[np.uintp]]: ...
+@overload
+def fill(
+    labels: NDArray[_T],
+    in_place: bool = False,
+    *,
+    return_fill_count: Literal[False] = False,
+    output: _OutputMode = "filled",
+    output_format: Literal["array"] = "array",
+    fill_value: Union[int, float, None] = None,
+    connectivity: _Connectivity = None,
+    max_hole_size: Union[int, None] = None,
+    max_hole_extent: _HoleExtent = None,
+    return_holes: Literal[True],
+    boundary: _Boundary = None,
+    seeds: _Seeds = None,
+    domain: Union[NDArray[typing.Any], None] = None,
+    foreground: None = None,
+    threshold: None = None,
+) -> tuple[NDArray[_T], _HolesStatistics]: ...
+@overload
+def fill(
+    labels: NDArray[_T],
+    in_place: bool = False,
+    *,
+    return_fill_count: Literal[True],
+    output: _OutputMode = "filled",
+    output_format: Literal["array"] = "array",
+    fill_value: Union[int, float, None] = None,
+    connectivity: _Connectivity = None,
+    max_hole_size: Union[int, None] = None,
+    max_hole_extent: _HoleExtent = None,
+    return_holes: Literal[True],
+    boundary: _Boundary = None,
+    seeds: _Seeds = None,
+    domain: Union[NDArray[typing.Any], None] = None,
+    foreground: None = None,
+    threshold: None = None,
+) -> tuple[NDArray[_T], int, _HolesStatistics]: ...
+@overload
+def fill(
+    labels: NDArray[typing.Any],
+    in_place: Literal[False] = False,
+    *,
+    return_fill_count: Literal[False] = False,
+    output: _OutputMode = "filled",
+    connectivity: _Connectivity = None,
+    max_hole_size: Union[int, None] = None,
+    max_hole_extent: _HoleExtent = None,
+    boundary: _Boundary = None,
+    seeds: _Seeds = None,
+    domain: Union[NDArray[typing.Any], None] = None,
+    foreground: Union[int, float, typing.Sequence[Union[int, float]], NDArray[typing.Any]],
+    threshold: None = None,
+) -> NDArray[np.bool_]: ...
+@overload
+def fill(
+    labels: NDArray[typing.Any],
+    in_place: Literal[False] = False,
+    *,
+    return_fill_count: Literal[True],
+    output: _OutputMode = "filled",
+    connectivity: _Connectivity = None,
+    max_hole_size: Union[int, None] = None,
+    max_hole_extent: _HoleExtent = None,
+    boundary: _Boundary = None,
+    seeds: _Seeds = None,
+    domain: Union[NDArray[typing.Any], None] = None,
+    foreground: Union[int, float, typing.Sequence[Union[int, float]], NDArray[typing.Any]],
+    threshold: None = None,
+) -> tuple[NDArray[np.bool_], int]: ...
+@overload
+def fill(
+    labels: NDArray[typing.Any],
+    in_place: Literal[False] = False,
+    *,
+    return_fill_count: Literal[False] = False,
+    output: _OutputMode = "filled",
+    connectivity: _Connectivity = None,
+    max_hole_size: Union[int, None] = None,
+    max_hole_extent: _HoleExtent = None,
+    boundary: _Boundary = None,
+    seeds: _Seeds = None,
+    domain: Union[NDArray[typing.Any], None] = None,
+    foreground: None = None,
+    threshold: float,
+) -> NDArray[np.bool_]: ...
+@overload
+def fill(
+    labels: NDArray[typing.Any],
+    in_place: Literal[False] = False,
+    *,
+    return_fill_count: Literal[True],
+    output: _OutputMode = "filled",
+    connectivity: _Connectivity = None,
+    max_hole_size: Union[int, None] = None,
+    max_hole_extent: _HoleExtent = None,
+    boundary: _Boundary = None,
+    seeds: _Seeds = None,
+    domain: Union[NDArray[typing.Any], None] = None,
+    foreground: None = None,
+    threshold: float,
+) -> tuple[NDArray[np.bool_], int]: ...
+@overload
+def fill(
+    labels: Union[_SupportsDLPack, memoryview],
+    in_place: bool = False,
+    return_fill_count: bool = False,
+    output: _OutputMode = "filled",
+    output_format: Literal["array", "packed"] = "array",
+    out_dtype: Union[DTypeLike, None] = None,
+    fill_value: Union[int, float, None] = None,
+    out: typing.Any = None,
+    batch_axes: Union[int, tuple[int, ...], None] = None,
+    threads: int = 0,
+    connectivity: _Connectivity = None,
+    max_hole_size: Union[int, None] = None,
+    max_hole_extent: _HoleExtent = None,
+    return_holes: bool = False,
+    boundary: _Boundary = None,
+    seeds: _Seeds = None,
+    domain: Union[NDArray[typing.Any], None] = None,
+    foreground: None = None,
+    threshold: None = None,
+) -> typing.Any: ...
 def fill(  # type: ignore[misc]
-    labels: NDArray[_T], in_place: bool = False, return_fill_count: bool = False
-) -> Union[NDArray[_T], tuple[NDArray[_T], int]]:
+    labels: NDArray[_T],
+    in_place: bool = False,
+    return_fill_count: bool = False,
+    output: _OutputMode = "filled",
+    output_format: Literal["array", "packed"] = "array",
+    out_dtype: DTypeLike = None,
+    fill_value: Union[int, float, None] = None,
+    out: None = None,
+    batch_axes: Union[int, tuple[int, ...], None] = None,
+    threads: int = 0,
+    connectivity: _Connectivity = None,
+    max_hole_size: Union[int, None] = None,
+    max_hole_extent: _HoleExtent = None,
+    return_holes: bool = False,
+    boundary: _Boundary = None,
+    seeds: _Seeds = None,
+    domain: Union[NDArray[typing.Any], None] = None,
+    foreground: _ForegroundIds = None,
+    threshold: Union[float, None] = None,
+) -> Union[
+    NDArray[_T],
+    tuple[NDArray[_T], int],
+    tuple[NDArray[_T], _HolesStatistics],
+    tuple[NDArray[_T], int, _HolesStatistics],
+    NDArray[typing.Any],
+    tuple[NDArray[typing.Any], int],
+    tuple[NDArray[_T], NDArray[np.uintp]],
+]:
     """Fills holes in a 1D, 2D, or 3D binary image.
 
     Args:
         labels: a binary valued numpy array of any common
-            integer or floating dtype
+            integer or floating dtype. Objects supporting DLPack
+            (e.g. PyTorch CPU tensors) or the buffer protocol are
+            accessed without a copy and array results are returned
+            as the same type as labels via its package's from_dlpack.
         in_place: bool, Allow modification of the input array (saves memory)
+            C and Fortran contiguous arrays and strided views (e.g.
+            volume[x0:x1, y0:y1, z0:z1]) are edited directly.
+            When False and there is nothing to fill in a 0/1 valued
+            input, a read-only view of labels is returned instead
+            of a copy.
         return_fill_count: Also return the number of voxels that were filled in.
+        output: which voxels are marked 1 in the result.
+            "filled": foreground and voids (default)
+            "holes": only the voids, equivalent to fill(labels) & ~labels
+            "exterior": only the background reachable from the border
+        output_format:
+            "array": the result has the same shape and dtype as labels (default)
+            "packed": the result is a 1D uint8 array holding 8 voxels per byte
+                in Fortran order, written directly from the fill. Recover the
+                image with np.unpackbits(result, count=labels.size).reshape(
+                labels.shape, order="F"). labels is never modified in this mode.
+        out_dtype: dtype of the result when output_format is "array".
+            Defaults to labels.dtype. Anything else (e.g. bool) is written
+            directly from the fill without making a copy of labels, so a
+            wide input never costs more than one compact output. labels is
+            not modified even if in_place is True.
+        fill_value: if not None, the result keeps the original values of
+            labels (rather than 0/1) and fill_value is written into the voids
+            only. With in_place=True this edits labels directly. Useful for
+            closing the holes of one label of a segmentation. Requires the
+            default output, output_format, and out_dtype.
+        out: if provided, a preallocated array of the same shape as labels
+            that the result is written into and returned as, e.g. shared
+            memory or a slice of a memmapped volume. labels is only read.
+            out may be any writable strided view and is written directly
+            without an intermediate image. Its dtype can be any of those
+            supported for labels and out_dtype and fill_value can't be
+            used with it. DLPack and buffer protocol objects are written
+            through without a copy.
+        batch_axes: if not None, an axis or tuple of axes of labels that
+            index independent 1D, 2D, or 3D images, e.g. 3 for an
+            (x, y, z, t) timelapse or (x, y, z, channel) stack. The
+            images are filled in parallel by a pool of C++ threads and
+            read and written through strides without copies. The fill
+            count is an array of the batch axes' shape. Voxels are only
+            connected within an image, not across batch axes. Can't be
+            combined with output_format="packed", out_dtype, fill_value,
+            or out.
+        threads: number of threads used with batch_axes, 0 means one
+            per core
+        connectivity: how background voxels connect to the exterior,
+            4 (default) or 8 in 2D and 6 (default), 18, or 26 in 3D.
+            Matches scipy's binary_fill_holes with the corresponding
+            structure. Higher values fill less as voids can escape
+            through diagonal gaps.
+        max_hole_size: if not None, only voids of at most this many
+            voxels are filled. Larger voids (e.g. a lumen) are left open
+            and count as exterior for output. Each void is measured by
+            flooding it once in C++, so no labeling pass is needed.
+        max_hole_extent: if not None, only voids whose bounding box spans
+            at most this many voxels along every axis are filled. An int
+            applies to all axes, otherwise give one value (or None) per
+            axis of labels. Can be combined with max_hole_size.
+        return_holes: Also return the statistics of each void that was
+    boundary: _Boundary = None,
+    seeds: _Seeds = None,
+    domain: Union[NDArray[typing.Any], None] = None,
+    foreground: _ForegroundIds = None,
+    threshold: Union[float, None] = None,
+            filled, gathered while measuring it in C++ instead of
+            labeling the holes afterwards. Voids are listed in memory
+            order of their first voxel.
+            Like cc3d.statistics, a dict of "voxel_counts" (uint64 array),
+            "bounding_boxes" (list of tuples of slices), and "centroids"
+            (float64 array of shape (N, labels.ndim)).
+        boundary: Which faces of the image the exterior is seeded from,
+            e.g. to process a chunk whose faces are partly seams with its
+            neighbors. "open" (the default) seeds from every face, "closed"
+            from none. Otherwise give two entries (low, high) per axis
+            in the order x, y, z, each "open", "closed" (a wall), or a
+            seed mask over the face's other axes in which nonzero marks
+            background that touches the outside (e.g. the exterior of
+            the neighboring chunk across a seam).
+            Defaults to "closed" when seeds are given.
+        seeds: Where the exterior is when it isn't (only) the image
+            border, e.g. a known extracellular label or points placed
+            by a proofreader: a bool mask of the shape of labels or
+            integer coordinates of shape (N, labels.ndim). The flood
+            starts from these in the same pass and everything it
+            doesn't reach is filled. Seeds on foreground are ignored.
+        foreground: If not None, the foreground is where labels equals
+            this value (e.g. a segment id) or any of a list of values
+            instead of where it is nonzero. Evaluated in C++ while
+            marking the foreground, so no binary copy of labels is
+            made. The output defaults to bool unless in_place or
+            fill_value is given.
+        threshold: If not None, the foreground is where labels is
+            greater than this value, e.g. for a grayscale image.
+        domain: Bool mask of the shape of labels marking valid data,
+            e.g. excluding dataset padding. Voxels outside of it keep
+            their value and are never flooded, but background touching
+            them counts as exterior.
 
     Returns:
-        A void filled binary image of the same dtype as labels with the number
+        A void filled binary image of dtype out_dtype followed by the
+        number of filled in background voxels if return_fill_count is
+        True and the void statistics if return_holes is True.
+    """
+
+@overload
+def fill_many(
+    labels_list: Iterable[NDArray[_T]],
+    threads: int = 0,
+    in_place: bool = False,
+    return_fill_count: Literal[False] = False,
+    output: _OutputMode = "filled",
+    connectivity: _Connectivity = None,
+) -> list[NDArray[_T]]: ...
+@overload
+def fill_many(
+    labels_list: Iterable[NDArray[_T]],
+    threads: int = 0,
+    in_place: bool = False,
+    *,
+    return_fill_count: Literal[True],
+    output: _OutputMode = "filled",
+    connectivity: _Connectivity = None,
+) -> tuple[list[NDArray[_T]], list[int]]: ...
+def fill_many(  # type: ignore[misc]
+    labels_list: Iterable[NDArray[_T]],
+    threads: int = 0,
+    in_place: bool = False,
+    return_fill_count: bool = False,
+    output: _OutputMode = "filled",
+    connectivity: _Connectivity = None,
+) -> Union[list[NDArray[_T]], tuple[list[NDArray[_T]], list[int]]]:
+    """Fills holes in many independent 1D, 2D, or 3D binary images at once.
+
+    The images (e.g. thousands of per-object crops) are filled
+    concurrently by a pool of C++ threads, largest first, without
+    holding the GIL.
+
+    Args:
+        labels_list: an iterable of binary valued arrays of any of the
+            types and dtypes accepted by fill. They don't need to share
+            a shape or dtype.
+        threads: number of threads to use, 0 means one per core
+        in_place: bool, Allow modification of the input arrays (saves
+            memory). Each array is edited as with fill.
+        return_fill_count: Also return the number of voxels that were
+            filled in for each image.
+        output: which voxels are marked 1, see fill
+        connectivity: of the background, see fill. Images get their
+            dimension's default when None.
+
+    Returns:
+        A list of void filled binary images in the same order as
+        labels_list with a list of the number of filled in background
+        voxels if return_fill_count is True.
+    """
+
+@overload
+def fill_slices(
+    volume: NDArray[_T],
+    axis: int = 2,
+    threads: int = 0,
+    in_place: bool = False,
+    return_fill_count: Literal[False] = False,
+    output: _OutputMode = "filled",
+    connectivity: _Connectivity = None,
+) -> NDArray[_T]: ...
+@overload
+def fill_slices(
+    volume: NDArray[_T],
+    axis: int = 2,
+    threads: int = 0,
+    in_place: bool = False,
+    *,
+    return_fill_count: Literal[True],
+    output: _OutputMode = "filled",
+    connectivity: _Connectivity = None,
+) -> tuple[NDArray[_T], NDArray[np.uintp]]: ...
+def fill_slices(  # type: ignore[misc]
+    volume: NDArray[_T],
+    axis: int = 2,
+    threads: int = 0,
+    in_place: bool = False,
+    return_fill_count: bool = False,
+    output: _OutputMode = "filled",
+    connectivity: _Connectivity = None,
+) -> Union[NDArray[_T], tuple[NDArray[_T], NDArray[np.uintp]]]:
+    """Fills holes in every 2D slice of a 3D binary volume independently.
+
+    Useful for e.g. each section of an anisotropic stack. The slices
+    are filled concurrently by a pool of C++ threads without holding
+    the GIL and are read and written in place through strides, so
+    slicing along any axis doesn't copy.
+
+    Args:
+        volume: a 3D binary valued array of any of the types and
+            dtypes accepted by fill
+        axis: the axis to slice along (default 2, i.e. z)
+        threads: number of threads to use, 0 means one per core
+        in_place: bool, Allow modification of the input array (saves
+            memory). Views are edited directly.
+        return_fill_count: Also return the number of voxels that were
+            filled in for each slice.
+        output: which voxels are marked 1, see fill
+        connectivity: of the background within each slice, 4 (default)
+            or 8
+
+    Returns:
+        volume with each slice along axis void filled with an array
+        of the number of filled in voxels per slice if
+        return_fill_count is True.
+    """
+
+@overload
+def fill_2p5d(
+    labels: NDArray[_T],
+    combine: Literal["union", "vote", "intersection"] = "union",
+    threads: int = 0,
+    return_fill_count: Literal[False] = False,
+) -> NDArray[_T]: ...
+@overload
+def fill_2p5d(
+    labels: NDArray[_T],
+    combine: Literal["union", "vote", "intersection"] = "union",
+    threads: int = 0,
+    *,
+    return_fill_count: Literal[True],
+) -> tuple[NDArray[_T], int]: ...
+def fill_2p5d(  # type: ignore[misc]
+    labels: NDArray[_T],
+    combine: Literal["union", "vote", "intersection"] = "union",
+    threads: int = 0,
+    return_fill_count: bool = False,
+) -> Union[NDArray[_T], tuple[NDArray[_T], int]]:
+    """2.5D fill of a 3D binary image for partly open objects.
+
+    Holes are filled slice by slice along x, then y, then z, each
+    axis adding its per voxel result to the output, and a final
+    pass applies combine. The slices of each axis are filled in
+    parallel by a pool of C++ threads without holding the GIL.
+    labels is only read.
+
+    Args:
+        labels: a 3D binary valued array of any of the types and
+            dtypes accepted by fill
+        combine: how a background voxel's three 2D results are merged
+            "union": filled in any of the x, y, or z slices (default)
+            "vote": filled in at least two of them
+            "intersection": filled in all three
+        threads: number of threads to use, 0 means one per core
+        return_fill_count: Also return the number of voxels that were
+            filled in.
+
+    Returns:
+        A void filled binary image of labels' dtype with the number
         of filled in background voxels if return_fill_count is True.
     """
 
+@overload
+def fill_labels(
+    labels: NDArray[_T],
+    in_place: bool = False,
+    return_fill_count: Literal[False] = False,
+    connectivity: _Connectivity = None,
+) -> NDArray[_T]: ...
+@overload
+def fill_labels(
+    labels: NDArray[_T],
+    in_place: bool = False,
+    *,
+    return_fill_count: Literal[True],
+    connectivity: _Connectivity = None,
+) -> tuple[NDArray[_T], int]: ...
+@overload
+def fill_labels(
+    labels: NDArray[_T],
+    in_place: bool,
+    return_fill_count: Literal[True],
+    connectivity: _Connectivity = None,
+) -> tuple[NDArray[_T], int]: ...
+def fill_labels(  # type: ignore[misc]
+    labels: NDArray[_T],
+    in_place: bool = False,
+    return_fill_count: bool = False,
+    connectivity: _Connectivity = None,
+) -> Union[NDArray[_T], tuple[NDArray[_T], int]]:
+    """Fills the holes of every label of a 1D, 2D, or 3D segmentation.
+
+    A hole is background (0) that can't reach the border and only
+    touches voxels of a single label, which is written into it.
+    Background between several labels is left as it is, and so are
+    labels nested inside of another one. Unlike calling
+    fill(seg, foreground=l, fill_value=l) for each label l, the
+    exterior is flooded once for all labels and then only the voids
+    are flooded again, so the cost doesn't grow with the number of
+    labels.
+
+    Args:
+        labels: a segmentation of any of the types and dtypes
+            accepted by fill
+        in_place: Allow modification of the input array. C and
+            Fortran contiguous arrays and strided views are edited
+            directly.
+        return_fill_count: Also return the number of voxels that were
+            filled in.
+        connectivity: of the background, see fill
+
+    Returns:
+        labels with its holes filled, with the number of filled in
+        background voxels if return_fill_count is True.
+    """
+
+def has_holes(labels: _ArrayInput, connectivity: _Connectivity = None) -> bool:
+    """Tests whether a 1D, 2D, or 3D binary image contains any voids.
+
+    This is much cheaper than fill as the input is neither copied
+    nor modified and the search stops as soon as the whole exterior
+    has been found.
+
+    Args:
+        labels: a binary valued numpy array of any common
+            integer or floating dtype, or a DLPack or buffer
+            protocol object (see fill)
+        connectivity: of the background, see fill
+
+    Returns:
+        True if any background voxel is enclosed by foreground.
+    """
+
+def count_voids(labels: _ArrayInput, connectivity: _Connectivity = None) -> int:
+    """Counts the voxels fill would fill in without copying or modifying labels.
+
+    The flood runs in a buffer of 2 bits per voxel, so memory usage
+    is much lower than fill's.
+
+    Args:
+        labels: a binary valued numpy array of any common
+            integer or floating dtype, or a DLPack or buffer
+            protocol object (see fill)
+        connectivity: of the background, see fill
+
+    Returns:
+        The number of enclosed background voxels.
+    """
+
 def void_shard() -> None: ...
@@ -1,3 +1,4 @@
+# cython: freethreading_compatible = True
 """
 Fill in holes in 3D binary images. 
 
@@ -46,11 +47,13 @@ from libcpp.utility cimport pair as cpp_pair
 cimport numpy as cnp
 import numpy as np
 
-import fastremap
-
 cdef extern from "math.h":
   float INFINITY
 
+# def functions taking NUMBER get a dispatcher generated by
+# Cython whose argument lookup trips warn.maybe_uninitialized
+# (it can't tell its error path always raises), so they turn
+# the check off for themselves.
 ctypedef fused NUMBER: 
   int8_t
   int16_t
@@ -64,129 +67,1970 @@ ctypedef fused NUMBER:
   float 
   double
 
-cdef extern from "fill_voids.hpp" namespace "fill_voids":
+cdef extern from "fill_voids.hpp" namespace "fill_voids" nogil:
+  cdef enum OutputMode:
+    FILLED
+    HOLES
+    EXTERIOR
+
+  cdef enum FacePolicy:
+    OPEN
+    CLOSED
+    SEEDED
+
+  cdef struct Boundaries:
+    FacePolicy faces[6]
+    const uint8_t* seeds[6]
+    const size_t* points
+    size_t num_points
+    const uint8_t* mask
+    const uint8_t* domain
+
+  cdef enum ForegroundKind:
+    NONZERO
+    EQUAL
+    ANY_OF
+    IN_RANGE
+
+  cdef struct Foreground:
+    ForegroundKind kind
+    const void* values
+    size_t num_values
+
   cdef size_t binary_fill_holes2d[T](
     T* labels, 
-    size_t sx, size_t sy
+    size_t sx, size_t sy,
+    OutputMode mode, int connectivity
   )
   cdef size_t binary_fill_holes3d[T](
     T* labels, 
-    size_t sx, size_t sy, size_t sz
+    size_t sx, size_t sy, size_t sz,
+    OutputMode mode, int connectivity
+  )
+  cdef size_t flood_voids2d[T](
+    const T* labels, uint8_t* buffer,
+    size_t sx, size_t sy,
+    int64_t csx, int64_t csy,
+    native_bool &is_binary, int connectivity,
+    const Boundaries* boundaries, const Foreground* foreground
+  )
+  cdef size_t flood_voids3d[T](
+    const T* labels, uint8_t* buffer,
+    size_t sx, size_t sy, size_t sz,
+    int64_t csx, int64_t csy, int64_t csz,
+    native_bool &is_binary, int connectivity,
+    const Boundaries* boundaries, const Foreground* foreground
   )
+  cdef struct VoidStats:
+    size_t voxels
+    size_t min_corner[3]
+    size_t max_corner[3]
+    double coord_sum[3]
+
+  cdef size_t filter_voids2d(
+    uint8_t* buffer,
+    size_t sx, size_t sy,
+    size_t num_voids, size_t max_size,
+    size_t max_extent_x, size_t max_extent_y,
+    int connectivity, vector[VoidStats]* stats
+  ) except +
+  cdef size_t filter_voids3d(
+    uint8_t* buffer,
+    size_t sx, size_t sy, size_t sz,
+    size_t num_voids, size_t max_size,
+    size_t max_extent_x, size_t max_extent_y, size_t max_extent_z,
+    int connectivity, vector[VoidStats]* stats
+  ) except +
+  cdef void write_output_buffer[U](
+    uint8_t* buffer, U* out, 
+    size_t sx, size_t sy, size_t sz,
+    int64_t csx, int64_t csy, int64_t csz,
+    OutputMode mode
+  )
+  cdef void write_fill_value_buffer[T](
+    uint8_t* buffer, T* out, 
+    size_t sx, size_t sy, size_t sz,
+    int64_t csx, int64_t csy, int64_t csz,
+    T fill_value
+  )
+  cdef void write_output_packed_buffer(
+    uint8_t* buffer, uint8_t* out,
+    size_t sx, size_t sy, size_t sz,
+    size_t csx, size_t csy, size_t csz,
+    OutputMode mode
+  )
+
+  cdef size_t binary_fill_holes_slices[T,U](
+    const T* labels, U* out,
+    size_t sx, size_t sy, size_t sz,
+    int64_t csx, int64_t csy, int64_t csz,
+    int64_t osx, int64_t osy, int64_t osz,
+    int axis, size_t* counts, 
+    size_t threads, OutputMode mode,
+    int connectivity
+  ) except +
+
+  cdef size_t binary_fill_holes_batch[T,U](
+    const T* labels, U* out,
+    size_t sx, size_t sy, size_t sz, int ndim,
+    int64_t csx, int64_t csy, int64_t csz,
+    int64_t osx, int64_t osy, int64_t osz,
+    const int64_t* offsets, const int64_t* out_offsets,
+    size_t num_volumes, size_t* counts,
+    size_t threads, OutputMode mode,
+    int connectivity
+  ) except +
+
+  cdef enum Combine:
+    UNION
+    VOTE
+    INTERSECTION
+
+  cdef size_t fill_labels2d[T](
+    T* labels, size_t sx, size_t sy,
+    int64_t csx, int64_t csy,
+    int connectivity
+  ) except +
+  cdef size_t fill_labels3d[T](
+    T* labels, size_t sx, size_t sy, size_t sz,
+    int64_t csx, int64_t csy, int64_t csz,
+    int connectivity
+  ) except +
+  cdef size_t binary_fill_holes_2p5d[T,U](
+    const T* labels, U* out,
+    size_t sx, size_t sy, size_t sz,
+    int64_t csx, int64_t csy, int64_t csz,
+    Combine combine, size_t threads
+  ) except +
+
+  cdef enum DataType:
+    UINT8
+    UINT16
+    UINT32
+    UINT64
+    FLOAT32
+    FLOAT64
+
+  cdef struct FillTask:
+    void* labels
+    DataType dtype
+    size_t sx
+    size_t sy
+    size_t sz
+    int ndim
+    OutputMode mode
+    int connectivity
+    size_t num_filled
+
+  cdef void binary_fill_holes_many(
+    vector[FillTask] &tasks, size_t threads
+  ) except +
 
 
 class DimensionError(Exception):
   pass
 
+_OUTPUT_MODES = {
+  "filled": FILLED,
+  "holes": HOLES,
+  "exterior": EXTERIOR,
+}
+
+_COMBINE_MODES = {
+  "union": UNION,
+  "vote": VOTE,
+  "intersection": INTERSECTION,
+}
+
 
 @cython.binding(True)
-def fill(labels, in_place=False, return_fill_count=False):
+def fill(
+  labels, in_place=False, return_fill_count=False, 
+  output="filled", output_format="array", out_dtype=None,
+  fill_value=None, out=None, batch_axes=None, threads=0,
+  connectivity=None, max_hole_size=None, max_hole_extent=None,
+  return_holes=False, boundary=None, seeds=None, domain=None,
+  foreground=None, threshold=None
+):
   """
   Fills holes in a 1D, 2D, or 3D binary image.
 
   labels: a binary valued numpy array of any common 
-    integer or floating dtype
+    integer or floating dtype. Objects supporting DLPack
+    (e.g. PyTorch CPU tensors) or the buffer protocol are
+    accessed without a copy and array results are returned
+    as the same type as labels via its package's from_dlpack.
 
   in_place: bool, Allow modification of the input array (saves memory)
+    C and Fortran contiguous arrays and strided views (e.g.
+    volume[x0:x1, y0:y1, z0:z1]) are edited directly.
+    When False and there is nothing to fill in a 0/1 valued
+    input, a read-only view of labels is returned instead 
+    of a copy.
   return_fill_count: Also return the number of voxels that were filled in.
+  output: which voxels are marked 1 in IMG
+    "filled": foreground and voids (default)
+    "holes": only the voids, equivalent to fill(labels) & ~labels
+    "exterior": only the background reachable from the border
+  output_format: 
+    "array": IMG has the same shape and dtype as labels (default)
+    "packed": IMG is a 1D uint8 array holding 8 voxels per byte
+      in Fortran order, written directly from the fill. 
+      Recover the image with:
+        np.unpackbits(IMG, count=labels.size).reshape(labels.shape, order='F')
+      labels is never modified in this mode.
+  out_dtype: dtype of IMG when output_format is "array". 
+    Defaults to labels.dtype. Anything else (e.g. bool) is 
+    written directly from the fill without making a copy of 
+    labels, so a wide input never costs more than one compact 
+    output. labels is not modified even if in_place is True.
 
-  Let IMG = a void filled binary image of the same dtype as labels
+  fill_value: if not None, IMG keeps the original values of 
+    labels (rather than 0/1) and fill_value is written into 
+    the voids only. With in_place=True this edits labels 
+    directly. Useful for closing the holes of one label 
+    of a segmentation. Requires the default output,
+    output_format, and out_dtype.
 
-  if return_fill_count:
+  out: if provided, a preallocated array of the same shape 
+    as labels that IMG is written into and returned as, 
+    e.g. shared memory or a slice of a memmapped volume. 
+    labels is only read. out may be any writable strided 
+    view and is written directly without an intermediate 
+    image. Its dtype can be any of those supported for 
+    labels and out_dtype and fill_value can't be used 
+    with it. DLPack and buffer protocol objects are 
+    written through without a copy.
+
+  batch_axes: if not None, an axis or tuple of axes of
+    labels that index independent 1D, 2D, or 3D images, 
+    e.g. 3 for an (x, y, z, t) timelapse or (x, y, z, 
+    channel) stack. The images are filled in parallel 
+    by a pool of C++ threads and read and written 
+    through strides without copies. The fill count is 
+    an array of the batch axes' shape. Voxels are only 
+    connected within an image, not across batch axes.
+    Can't be combined with output_format="packed", 
+    out_dtype, fill_value, or out.
+  threads: number of threads used with batch_axes,
+    0 means one per core
+  connectivity: how background voxels connect to the 
+    exterior, 4 (default) or 8 in 2D and 6 (default), 
+    18, or 26 in 3D. Matches scipy's binary_fill_holes 
+    with the corresponding structure. Higher values fill 
+    less as voids can escape through diagonal gaps.
+  max_hole_size: if not None, only voids of at most this 
+    many voxels are filled. Larger voids (e.g. a lumen) 
+    are left open and count as exterior for output. Each 
+    void is measured by flooding it once in C++, so no 
+    labeling pass is needed.
+  max_hole_extent: if not None, only voids whose bounding 
+    box spans at most this many voxels along every axis 
+    are filled. An int applies to all axes, otherwise 
+    give one value (or None) per axis of labels. Can be 
+    combined with max_hole_size.
+  return_holes: Also return the statistics of each void 
+    that was filled, gathered while measuring it in C++ 
+    instead of labeling the holes afterwards. Voids are 
+    listed in memory order of their first voxel. Like 
+    cc3d.statistics:
+    {
+      "voxel_counts": uint64 array of voxels per void,
+      "bounding_boxes": list of tuples of slices,
+      "centroids": float64 array of shape (N, labels.ndim),
+    }
+  boundary: which faces of the image the exterior is 
+    seeded from, e.g. for chunks whose faces are partly 
+    seams with neighboring chunks. "open" seeds from every
+    face, "closed" from none. None is "open" unless seeds
+    are given, then "closed". Otherwise give two entries 
+    (low, high) per axis of labels in the order x, y, z, 
+    each one of:
+      "open": the face touches the outside
+      "closed": the face is a wall
+      a seed mask over the face's other axes (e.g. of 
+        shape (sy, sz) for the x faces): only background 
+        where the mask is nonzero is outside, e.g. the 
+        exterior of the neighboring chunk at the seam
+    Faces of the axis added to 1D images are closed.
+  seeds: where the exterior is, when it isn't (only) the 
+    image border, e.g. a known extracellular label or 
+    points placed by a proofreader. Either a bool mask of 
+    the same shape as labels or integer coordinates of 
+    shape (N, labels.ndim). The flood starts from these 
+    (and the faces chosen by boundary) in the same pass, 
+    and everything it doesn't reach is filled. Seeds on 
+    foreground are ignored.
+  foreground: if not None, the foreground is where labels
+    equals this value (e.g. a segment id) or, given a 
+    list, any of these values instead of where labels is 
+    nonzero. The predicate is evaluated in C++ while 
+    marking the foreground, so no binary copy of labels 
+    is made. The output defaults to bool unless in_place
+    or fill_value is given.
+    fill(seg, foreground=segid, fill_value=segid, 
+    in_place=True) closes the holes of one segment of 
+    seg directly.
+  threshold: if not None, the foreground is where labels 
+    is greater than this value, e.g. for a grayscale image.
+    Can't be combined with foreground.
+  domain: bool mask of the same shape as labels marking
+    valid data, e.g. excluding dataset padding or space 
+    outside the imaged tissue. Voxels outside of it keep 
+    their value and are never flooded, but background 
+    touching them counts as exterior. A bool array in
+    the same memory order as labels is used without a 
+    copy.
+
+  Let IMG = a void filled binary image of dtype out_dtype
+
+  if return_fill_count and return_holes:
+    Return: (IMG, number of filled in background voxels, HOLES)
+  elif return_fill_count:
     Return: (IMG, number of filled in background voxels)
+  elif return_holes:
+    Return: (IMG, HOLES)
   else:
     Return: IMG
   """
+  original = labels
+  original_out = out
+  labels = _as_ndarray(labels)
+  if out is not None:
+    out = _as_ndarray(out)
+
   ndim = labels.ndim 
   shape = labels.shape 
 
-  if labels.ndim < 2:
-    labels = labels[..., np.newaxis]
-  while labels.ndim > 3:
-    if labels.shape[-1] == 1:
-      labels = labels[..., 0]
-    else:
-      raise DimensionError("The input volume must be (effectively) a 1D, 2D or 3D image: " + str(shape))
+  if output not in _OUTPUT_MODES:
+    raise ValueError("output must be one of {}. Got: {}".format(list(_OUTPUT_MODES.keys()), output))
+  mode = _OUTPUT_MODES[output]
+
+  if output_format not in ("array", "packed"):
+    raise ValueError("output_format must be \"array\" or \"packed\". Got: {}".format(output_format))
+  if output_format == "packed" and out_dtype is not None:
+    raise ValueError("out_dtype cannot be used with output_format=\"packed\".")
+  if fill_value is not None and (
+    mode != FILLED or output_format != "array" or out_dtype is not None
+  ):
+    raise ValueError("fill_value can only be used with the default output, output_format, and out_dtype.")
+  if out is not None:
+    if output_format != "array" or out_dtype is not None or fill_value is not None:
+      raise ValueError("out cannot be used with output_format=\"packed\", out_dtype, or fill_value.")
+    if out.shape != labels.shape:
+      raise ValueError("out must have the same shape as labels. Got: {} and {}".format(out.shape, labels.shape))
+    _check_writeable(out, "out")
+    _check_element_strided(out, "out")
+  if batch_axes is not None:
+    if output_format != "array" or out_dtype is not None or fill_value is not None or out is not None:
+      raise ValueError("batch_axes cannot be used with output_format=\"packed\", out_dtype, fill_value, or out.")
+    if max_hole_size is not None or max_hole_extent is not None or return_holes or boundary is not None or seeds is not None or domain is not None:
+      raise ValueError("batch_axes cannot be used with max_hole_size, max_hole_extent, return_holes, boundary, seeds, or domain.")
+    if foreground is not None or threshold is not None:
+      raise ValueError("batch_axes cannot be used with foreground or threshold.")
+    (labels, num_filled) = _fill_batch(labels, batch_axes, mode, in_place, threads, connectivity)
+    labels = _as_framework(labels, original)
+    return (labels, num_filled) if return_fill_count else labels
+
+  labels = _as_2d_or_3d(labels)
+  connectivity = _connectivity(connectivity, labels.ndim)
+  void_filter = _void_filter(max_hole_size, max_hole_extent, return_holes, ndim)
+  exterior = _exterior(boundary, seeds, domain, labels.shape, ndim)
+  predicate = _predicate(foreground, threshold, labels.dtype)
 
   dtype = labels.dtype
   if labels.dtype == bool:
     labels = labels.view(np.uint8)
 
-  if labels.size == 0:
-    num_filled = 0
-  elif labels.ndim == 2:
-    (labels, num_filled) = _fill2d(labels, in_place)
-  elif labels.ndim == 3:
-    (labels, num_filled) = _fill3d(labels, in_place)
+  if out_dtype is None:
+    # a mask picked out of e.g. a segmentation is returned as bool
+    if predicate is not None and not in_place and fill_value is None:
+      out_dtype = bool
+    else:
+      out_dtype = dtype
+  out_dtype = np.dtype(out_dtype)
+  if out_dtype == bool:
+    storage_dtype = np.dtype(np.uint8)
   else:
+    storage_dtype = out_dtype
+
+  writes_labels = in_place and out is None and output_format == "array" and (
+    fill_value is not None or out_dtype == dtype
+  )
+  if not writes_labels:
+    labels = _as_element_strided(labels)
+
+  if labels.ndim not in (2,3):
     raise DimensionError("fill_voids only handles 1D, 2D, and 3D data. Got: " + str(shape))
+  elif out is not None:
+    if labels.size == 0:
+      num_filled = 0
+    else:
+      num_filled = _fill_out(labels, mode, _as_2d_or_3d(out), connectivity, void_filter, exterior, predicate)
+    return _fill_result(original_out, num_filled, void_filter, ndim, return_fill_count)
+  elif output_format == "packed":
+    if labels.size == 0:
+      packed = np.zeros((0,), dtype=np.uint8)
+      num_filled = 0
+    else:
+      (packed, num_filled) = _fill_packed(labels, mode, connectivity, void_filter, exterior, predicate)
+    packed = _as_framework(packed, original)
+    return _fill_result(packed, num_filled, void_filter, ndim, return_fill_count)
+  elif fill_value is not None:
+    if labels.size == 0:
+      num_filled = 0
+    else:
+      (labels, num_filled) = _fill_value(labels, fill_value, in_place, connectivity, void_filter, exterior, predicate)
+  elif labels.size == 0:
+    if storage_dtype != labels.dtype:
+      labels = np.zeros(labels.shape, dtype=storage_dtype)
+    num_filled = 0
+  elif not in_place or out_dtype != dtype:
+    (labels, num_filled) = _fill_lazy(labels, mode, storage_dtype, connectivity, void_filter, exterior, predicate)
+  else:
+    (labels, num_filled) = _fill_in_place(labels, mode, connectivity, void_filter, exterior, predicate)
 
   while labels.ndim > ndim:
     labels = labels[..., 0]
   while labels.ndim < ndim:
     labels = labels[..., np.newaxis]
 
-  labels = labels.view(dtype)
+  labels = _as_framework(labels.view(out_dtype), original)
+  return _fill_result(labels, num_filled, void_filter, ndim, return_fill_count)
+
+def _fill_result(img, num_filled, void_filter, ndim, return_fill_count):
+  result = (img,)
+  if return_fill_count:
+    result += (num_filled,)
+  if void_filter is not None and void_filter.gather_stats:
+    result += (_holes_statistics(void_filter, ndim),)
+  return result if len(result) > 1 else img
+
+@cython.binding(True)
+def fill_many(
+  labels_list, threads=0, in_place=False, 
+  return_fill_count=False, output="filled",
+  connectivity=None
+):
+  """
+  Fills holes in many independent 1D, 2D, or 3D binary 
+  images at once, e.g. thousands of per-object crops. 
+  The images are filled concurrently by a pool of C++ 
+  threads, largest first, without holding the GIL.
+
+  labels_list: an iterable of binary valued arrays of 
+    any of the types and dtypes accepted by fill.
+    They don't need to share a shape or dtype.
+  threads: number of threads to use, 0 means one per core
+  in_place: bool, Allow modification of the input arrays
+    (saves memory). Each array is edited as with fill.
+  return_fill_count: Also return the number of voxels 
+    that were filled in for each image.
+  output: which voxels are marked 1, see fill
+  connectivity: of the background, see fill. Images 
+    get their dimension's default when None.
+
+  Let IMGS = a list of void filled binary images in the
+    same order as labels_list
+
+  if return_fill_count:
+    Return: (IMGS, list of number of filled in background voxels)
+  else:
+    Return: IMGS
+  """
+  if output not in _OUTPUT_MODES:
+    raise ValueError("output must be one of {}. Got: {}".format(list(_OUTPUT_MODES.keys()), output))
+  cdef OutputMode mode = _OUTPUT_MODES[output]
+
+  cdef vector[FillTask] tasks
+  cdef FillTask task
+  cdef size_t num_threads = threads
+  
+  jobs = []
+  for labels in labels_list:
+    original = labels
+    labels = _as_ndarray(labels)
+    ndim = labels.ndim
+    shape = labels.shape
+    dtype = labels.dtype
+
+    labels = _as_2d_or_3d(labels)
+    if labels.ndim not in (2,3):
+      raise DimensionError("fill_voids only handles 1D, 2D, and 3D data. Got: " + str(shape))
+    if labels.dtype == bool:
+      labels = labels.view(np.uint8)
+    task.connectivity = _connectivity(connectivity, labels.ndim)
+
+    if in_place:
+      _check_writeable(labels, "labels")
+
+    # non-contiguous or unaligned views are filled in 
+    # a copy and written back if in_place
+    copied = not in_place or not (labels.flags.f_contiguous or labels.flags.c_contiguous) or not _is_element_strided(labels)
+    work = np.copy(labels, order='K') if copied else labels
+    (work, transposed) = _as_fortran(work)
+
+    index = -1
+    if work.size > 0:
+      task.labels = cnp.PyArray_DATA(work)
+      task.dtype = _data_type(work.dtype)
+      task.sx = work.shape[0]
+      task.sy = work.shape[1]
+      task.sz = work.shape[2] if work.ndim == 3 else 1
+      task.ndim = work.ndim
+      task.mode = mode
+      task.num_filled = 0
+      index = tasks.size()
+      tasks.push_back(task)
+
+    jobs.append((original, labels, work, copied, transposed, index, ndim, dtype))
+
+  with nogil:
+    binary_fill_holes_many(tasks, num_threads)
+
+  results = []
+  counts = []
+  for (original, labels, work, copied, transposed, index, ndim, dtype) in jobs:
+    if transposed:
+      work = work.T
+    if in_place and copied:
+      labels[...] = work
+      work = labels
+
+    while work.ndim > ndim:
+      work = work[..., 0]
+    while work.ndim < ndim:
+      work = work[..., np.newaxis]
+
+    results.append(_as_framework(work.view(dtype), original))
+    counts.append(tasks[index].num_filled if index >= 0 else 0)
+
+  if return_fill_count:
+    return (results, counts)
+  else:
+    return results
+
+@cython.binding(True)
+def fill_slices(
+  volume, axis=2, threads=0, in_place=False, 
+  return_fill_count=False, output="filled",
+  connectivity=None
+):
+  """
+  Fills holes in every 2D slice of a 3D binary volume
+  independently, e.g. each section of an anisotropic 
+  stack. The slices are filled concurrently by a pool 
+  of C++ threads without holding the GIL and are read 
+  and written in place through strides, so slicing along 
+  any axis doesn't copy.
+
+  volume: a 3D binary valued array of any of the types
+    and dtypes accepted by fill
+  axis: the axis to slice along (default 2, i.e. z)
+  threads: number of threads to use, 0 means one per core
+  in_place: bool, Allow modification of the input array 
+    (saves memory). Views are edited directly.
+  return_fill_count: Also return the number of voxels 
+    that were filled in for each slice.
+  output: which voxels are marked 1, see fill
+  connectivity: of the background within each slice,
+    4 (default) or 8
+
+  Let IMG = volume with each slice along axis void filled
+
+  if return_fill_count:
+    Return: (IMG, array of filled voxels per slice)
+  else:
+    Return: IMG
+  """
+  if output not in _OUTPUT_MODES:
+    raise ValueError("output must be one of {}. Got: {}".format(list(_OUTPUT_MODES.keys()), output))
+  mode = _OUTPUT_MODES[output]
+
+  original = volume
+  volume = _as_ndarray(volume)
+  if volume.ndim != 3:
+    raise DimensionError("fill_slices requires a 3D volume. Got: " + str(volume.shape))
+  if not -3 <= axis < 3:
+    raise ValueError("axis must be 0, 1, or 2. Got: {}".format(axis))
+  axis = axis % 3
+  connectivity = _connectivity(connectivity, 2)
+
+  dtype = volume.dtype
+  labels = volume.view(np.uint8) if dtype == bool else volume
+
+  if in_place:
+    _check_writeable(labels, "volume")
+    _check_element_strided(labels, "volume")
+    out = labels
+  else:
+    labels = _as_element_strided(labels)
+    out = np.empty_like(labels, order='K')
+
+  counts = np.zeros((labels.shape[axis],), dtype=np.uintp)
+  if labels.size > 0:
+    _fill_slices(labels, out, axis, counts, threads, mode, connectivity)
+
+  out = _as_framework(out.view(dtype), original)
 
   if return_fill_count:
-    return (labels, num_filled)
+    return (out, counts)
   else:
+    return out
+
+@cython.binding(True)
+def fill_2p5d(labels, combine="union", threads=0, return_fill_count=False):
+  """
+  2.5D fill of a 3D binary image for partly open objects. 
+  Holes are filled slice by slice along x, then y, then z, 
+  each axis adding its per voxel result to the output, and 
+  a final pass applies combine. The slices of each axis 
+  are filled in parallel by a pool of C++ threads without 
+  holding the GIL. labels is only read.
+
+  labels: a 3D binary valued array of any of the types
+    and dtypes accepted by fill
+  combine: how a background voxel's three 2D results 
+    are merged
+    "union": filled in any of the x, y, or z slices (default)
+    "vote": filled in at least two of them
+    "intersection": filled in all three
+  threads: number of threads to use, 0 means one per core
+  return_fill_count: Also return the number of voxels 
+    that were filled in.
+
+  Let IMG = a void filled binary image of labels' dtype
+
+  if return_fill_count:
+    Return: (IMG, number of filled in background voxels)
+  else:
+    Return: IMG
+  """
+  if combine not in _COMBINE_MODES:
+    raise ValueError("combine must be one of {}. Got: {}".format(list(_COMBINE_MODES.keys()), combine))
+
+  original = labels
+  labels = _as_ndarray(labels)
+  if labels.ndim != 3:
+    raise DimensionError("fill_2p5d requires a 3D image. Got: " + str(labels.shape))
+
+  dtype = labels.dtype
+  if dtype == bool:
+    labels = labels.view(np.uint8)
+  labels = _as_element_strided(labels)
+
+  (labels, transposed) = _as_fortran(labels)
+  out = np.empty(labels.shape, dtype=labels.dtype, order='F')
+
+  num_filled = 0
+  if labels.size > 0:
+    num_filled = _fill_2p5d(labels, out, _COMBINE_MODES[combine], threads)
+
+  if transposed:
+    out = out.T
+  out = _as_framework(out.view(dtype), original)
+
+  if return_fill_count:
+    return (out, num_filled)
+  else:
+    return out
+
+@cython.binding(True)
+def fill_labels(labels, in_place=False, return_fill_count=False, connectivity=None):
+  """
+  Fills the holes of every label of a 1D, 2D, or 3D 
+  segmentation at once. A hole is background (0) that 
+  can't reach the border and only touches voxels of a 
+  single label, which is written into it. Background 
+  between several labels is left as it is, and so are
+  labels nested inside of another one. 
+
+  Unlike calling fill(seg, foreground=l, fill_value=l) 
+  for each label l, the exterior is flooded once for 
+  all labels and then only the voids are flooded again,
+  so the cost doesn't grow with the number of labels.
+
+  labels: a segmentation of any of the types and dtypes 
+    accepted by fill
+  in_place: bool, Allow modification of the input array.
+    C and Fortran contiguous arrays and strided views 
+    are edited directly.
+  return_fill_count: Also return the number of voxels 
+    that were filled in.
+  connectivity: of the background, see fill
+
+  Let SEG = labels with its holes filled
+
+  if return_fill_count:
+    Return: (SEG, number of filled in background voxels)
+  else:
+    Return: SEG
+  """
+  original = labels
+  labels = _as_ndarray(labels)
+  shape = labels.shape
+
+  if in_place:
+    _check_writeable(labels, "labels")
+    _check_element_strided(labels, "labels")
+  else:
+    labels = np.copy(labels, order='K')
+  result = labels
+
+  labels = _as_2d_or_3d(labels)
+  if labels.ndim not in (2,3):
+    raise DimensionError("fill_voids only handles 1D, 2D, and 3D data. Got: " + str(shape))
+  connectivity = _connectivity(connectivity, labels.ndim)
+
+  if labels.dtype == bool:
+    labels = labels.view(np.uint8)
+  labels = _as_fortran(labels)[0]
+
+  num_filled = 0
+  if labels.size > 0:
+    if labels.ndim == 2:
+      num_filled = _fill_labels2d(labels, connectivity)
+    else:
+      num_filled = _fill_labels3d(labels, connectivity)
+
+  result = _as_framework(result, original)
+
+  if return_fill_count:
+    return (result, num_filled)
+  else:
+    return result
+
+@cython.binding(True)
+def has_holes(labels, connectivity=None):
+  """
+  Tests whether a 1D, 2D, or 3D binary image contains
+  any voids. This is much cheaper than fill as the 
+  input is neither copied nor modified and the search 
+  stops as soon as the whole exterior has been found.
+
+  labels: a binary valued numpy array of any common 
+    integer or floating dtype, or a DLPack or buffer 
+    protocol object (see fill)
+  connectivity: of the background, see fill
+
+  Return: bool
+  """
+  return count_voids(labels, connectivity) > 0
+
+@cython.binding(True)
+def count_voids(labels, connectivity=None):
+  """
+  Counts the number of voxels that fill would fill in
+  for a 1D, 2D, or 3D binary image without copying or 
+  modifying it. The flood runs in a buffer of 2 bits 
+  per voxel, so memory usage is much lower than fill's.
+
+  labels: a binary valued numpy array of any common 
+    integer or floating dtype, or a DLPack or buffer 
+    protocol object (see fill)
+  connectivity: of the background, see fill
+
+  Return: number of enclosed background voxels (int)
+  """
+  labels = _as_ndarray(labels)
+  shape = labels.shape
+  labels = _as_2d_or_3d(labels)
+
+  if labels.dtype == bool:
+    labels = labels.view(np.uint8)
+
+  if labels.size == 0:
+    return 0
+
+  if labels.ndim not in (2,3):
+    raise DimensionError("fill_voids only handles 1D, 2D, and 3D data. Got: " + str(shape))
+
+  connectivity = _connectivity(connectivity, labels.ndim)
+  labels = _as_element_strided(labels)
+  return _flood_exterior(labels, connectivity)[2]
+
+def _as_ndarray(labels):
+  """
+  Wraps objects exporting DLPack (e.g. PyTorch CPU tensors) 
+  or the buffer protocol as numpy arrays sharing their 
+  memory so they can be read and edited without a copy.
+  """
+  if isinstance(labels, np.ndarray):
     return labels
+  elif hasattr(labels, "__dlpack__"):
+    return np.from_dlpack(labels)
+  return np.asarray(labels)
+
+def _as_framework(result, original):
+  """
+  Returns result as the same kind of array as the input 
+  to fill using the from_dlpack of the input's package
+  (e.g. torch.from_dlpack), sharing result's memory. 
+  A read-only result is an unmodified view of the input. 
+  It is exported read-only if the package supports that 
+  and copied otherwise, never returning the input itself.
+  Anything else is returned as a numpy array.
+  """
+  if isinstance(original, np.ndarray) or not hasattr(original, "__dlpack__"):
+    return result
+
+  package = sys.modules.get(type(original).__module__.split(".")[0])
+  from_dlpack = getattr(package, "from_dlpack", None)
+  if from_dlpack is None:
+    return result
+  elif not result.flags.writeable:
+    try:
+      return from_dlpack(result)
+    except BufferError:
+      return from_dlpack(np.copy(result))
+  return from_dlpack(result)
+
+def _fill_batch(labels, batch_axes, mode, in_place, threads, connectivity):
+  """
+  Fills each image along batch_axes of labels independently
+  in C++. The remaining (spatial) axes are flooded smallest 
+  stride first as voids don't depend on axis order.
+
+  Returns: (IMG, fill counts in the shape of the batch axes)
+  """
+  ndim = labels.ndim
+  if isinstance(batch_axes, int):
+    batch_axes = (batch_axes,)
+  batch_axes = [ axis % ndim for axis in batch_axes ]
+  if len(set(batch_axes)) != len(batch_axes):
+    raise ValueError("batch_axes must not repeat. Got: {}".format(batch_axes))
+
+  spatial_axes = [ axis for axis in range(ndim) if axis not in batch_axes ]
+  if not 1 <= len(spatial_axes) <= 3:
+    raise DimensionError(
+      "batch_axes must leave 1, 2, or 3 dimensions to fill. Got: {} with batch_axes {}".format(labels.shape, batch_axes)
+    )
+  spatial_axes.sort(key=lambda axis: abs(labels.strides[axis]))
+  connectivity = _connectivity(connectivity, max(len(spatial_axes), 2))
+
+  dtype = labels.dtype
+  if dtype == bool:
+    labels = labels.view(np.uint8)
+
+  if in_place:
+    _check_writeable(labels, "labels")
+    _check_element_strided(labels, "labels")
+  else:
+    labels = _as_element_strided(labels)
+  out = labels if in_place else np.empty_like(labels, order='K')
+
+  batch_shape = tuple([ labels.shape[axis] for axis in batch_axes ])
+  counts = np.zeros(batch_shape, dtype=np.uintp)
+
+  if labels.size > 0:
+    _fill_batch_dispatch(
+      labels, out, spatial_axes, batch_axes, 
+      counts.reshape(-1), threads, mode, connectivity
+    )
+
+  return (out.view(dtype), counts)
+
+def _batch_offsets(arr, batch_axes):
+  """Element offset of each batch image in C order of the batch axes."""
+  offsets = np.zeros([ arr.shape[axis] for axis in batch_axes ], dtype=np.int64)
+  for i, axis in enumerate(batch_axes):
+    index_shape = [1] * len(batch_axes)
+    index_shape[i] = arr.shape[axis]
+    stride = arr.strides[axis] // arr.itemsize
+    offsets += (np.arange(arr.shape[axis], dtype=np.int64) * stride).reshape(index_shape)
+  return np.ascontiguousarray(offsets.reshape(-1))
+
+def _data_type(dtype):
+  if dtype in (np.uint8, np.int8, bool):
+    return UINT8
+  elif dtype in (np.uint16, np.int16):
+    return UINT16
+  elif dtype in (np.uint32, np.int32):
+    return UINT32
+  elif dtype in (np.uint64, np.int64):
+    return UINT64
+  elif dtype == np.float32:
+    return FLOAT32
+  elif dtype == np.float64:
+    return FLOAT64
+  else:
+    raise TypeError("Type {} not supported.".format(dtype))
+
+def _connectivity(connectivity, ndim):
+  """Validates connectivity for a 2D or 3D image, None is face connected."""
+  if ndim == 2:
+    allowed = [4, 8]
+  else:
+    allowed = [6, 18, 26]
+  if connectivity is None:
+    return allowed[0]
+  if connectivity not in allowed:
+    raise ValueError("connectivity must be one of {} for {}D images. Got: {}".format(allowed, ndim, connectivity))
+  return int(connectivity)
+
+_SIZE_MAX = np.iinfo(np.uintp).max
+
+def _predicate(foreground, threshold, dtype):
+  """
+  Validates the foreground and threshold arguments of 
+  fill for labels of dtype.
+
+  Returns: None if the foreground is the nonzero voxels,
+    else (ForegroundKind, values) where values are in 
+    the unsigned (or float) type labels of dtype are 
+    read as in C++. See Foreground in fill_voids.hpp.
+  """
+  if foreground is None and threshold is None:
+    return None
+  if foreground is not None and threshold is not None:
+    raise ValueError("foreground and threshold cannot be used together.")
+
+  dtype = np.dtype(dtype)
+  if dtype == bool:
+    storage_dtype = np.dtype(np.uint8)
+  elif dtype.kind in "iu":
+    storage_dtype = np.dtype("uint{}".format(dtype.itemsize * 8))
+  else:
+    storage_dtype = dtype
+
+  nothing = (ANY_OF, np.zeros((0,), dtype=storage_dtype))
+
+  if threshold is not None:
+    # voxels > threshold as the range [lo, max]
+    threshold = float(threshold)
+    if np.isnan(threshold) or threshold == np.inf:
+      return nothing
+    if dtype.kind == "f":
+      # compared as python floats so nothing overflows
+      finfo = np.finfo(dtype)
+      if threshold >= float(finfo.max):
+        lo = dtype.type(np.inf)
+      else:
+        lo = dtype.type(max(threshold, float(finfo.min)))
+        if not float(lo) > threshold:
+          lo = np.nextafter(lo, dtype.type(np.inf))
+      hi = np.inf
+    else:
+      (dmin, dmax) = (0, 1) if dtype == bool else (np.iinfo(dtype).min, np.iinfo(dtype).max)
+      if threshold == -np.inf:
+        lo = dmin
+      else:
+        lo = max(int(np.floor(threshold)) + 1, int(dmin))
+      if lo > dmax:
+        return nothing
+      hi = dmax
+    values = np.array([ lo, hi ], dtype=dtype).view(storage_dtype)
+    return (IN_RANGE, values)
+
+  if np.isscalar(foreground):
+    ids = [ foreground ]
+  else:
+    ids = list(np.asarray(foreground, dtype=object).ravel())
+
+  # ids that can't occur in labels never match
+  values = [ segid for segid in ids if _representable(segid, dtype) ]
+  if len(values) == 0:
+    return nothing
+  values = np.unique(np.array(values, dtype=dtype).view(storage_dtype))
+  if values.size == 1:
+    return (EQUAL, values)
+  return (ANY_OF, values)
+
+def _representable(value, dtype):
+  """Whether value can be stored in dtype exactly."""
+  try:
+    if dtype.kind == "f":
+      return bool(dtype.type(value) == value)
+    if int(value) != value:
+      return False
+  except (TypeError, ValueError, OverflowError):
+    return False
+  if dtype == bool:
+    return int(value) in (0, 1)
+  return np.iinfo(dtype).min <= int(value) <= np.iinfo(dtype).max
+
+_FACE_POLICIES = {
+  "open": OPEN,
+  "closed": CLOSED,
+}
+
+class _Exterior:
+  """
+  Where the exterior flood of fill starts, on the axes
+  of labels as passed to _flood_exterior. See _exterior 
+  and Boundaries in fill_voids.hpp.
+  """
+  def __init__(self, faces, coords, mask, domain=None):
+    self.faces = faces # (FacePolicy, face seed mask or None) per face
+    self.coords = coords # int64 array of shape (N, 3) or None
+    self.mask = mask # bool array of the image's shape or None
+    self.domain = domain # bool array of the image's shape or None
+    self.arrays = None # what Boundaries points into, see _set_boundaries
+
+  def transposed(self):
+    """The same exterior for the transposed image."""
+    num_axes = len(self.faces) // 2
+    faces = []
+    for axis in reversed(range(num_axes)):
+      for face in (2 * axis, 2 * axis + 1):
+        (policy, face_seeds) = self.faces[face]
+        if face_seeds is not None:
+          face_seeds = np.asfortranarray(face_seeds.T)
+        faces.append((policy, face_seeds))
+
+    coords = self.coords
+    if coords is not None:
+      coords = coords[:, :num_axes][:, ::-1]
+    mask = self.mask
+    if mask is not None:
+      mask = mask.T
+    domain = self.domain
+    if domain is not None:
+      domain = domain.T
+    return _Exterior(faces, coords, mask, domain)
+
+def _exterior(boundary, seeds, domain, shape, ndim):
+  """
+  Validates the boundary, seeds, and domain arguments of 
+  fill for an image of shape (as from _as_2d_or_3d) that 
+  had ndim axes. Without seeds, faces default to open, 
+  with them to closed.
+
+  Returns: None if the exterior is seeded from every face
+    and nowhere else, otherwise an _Exterior. Face seed 
+    masks are uint8 in Fortran order over the face's other
+    axes in the order of Boundaries in fill_voids.hpp.
+  """
+  if boundary is None and seeds is None and domain is None:
+    return None
+  if boundary is None:
+    boundary = "open" if seeds is None else "closed"
+
+  num_faces = 2 * len(shape)
+  if isinstance(boundary, str):
+    faces = [ boundary ] * num_faces
+  else:
+    faces = list(boundary)
+    if len(faces) != 2 * ndim:
+      raise ValueError("boundary must have two entries (low, high) per axis ({}). Got: {}".format(2 * ndim, len(faces)))
+    # axes added to 1D images are walls
+    faces = faces[:num_faces] + [ "closed" ] * (num_faces - len(faces))
+
+  result = []
+  for face, policy in enumerate(faces):
+    axis = face // 2
+    face_shape = tuple([ size for i, size in enumerate(shape) if i != axis ])
+    if isinstance(policy, str):
+      if policy not in _FACE_POLICIES:
+        raise ValueError("boundary faces must be one of {} or a seed mask. Got: {}".format(list(_FACE_POLICIES.keys()), policy))
+      result.append((_FACE_POLICIES[policy], None))
+      continue
+
+    face_seeds = _as_ndarray(policy)
+    if _without_trailing_ones(face_seeds.shape) != _without_trailing_ones(face_shape):
+      raise ValueError("The seed mask of face {} must have shape {}. Got: {}".format(face, face_shape, face_seeds.shape))
+    face_seeds = np.asfortranarray(face_seeds.reshape(face_shape) != 0).view(np.uint8)
+    result.append((SEEDED, face_seeds))
+
+  (coords, mask) = _seeds(seeds, shape, ndim)
+
+  if domain is not None:
+    domain = _as_ndarray(domain)
+    if _without_trailing_ones(domain.shape) != _without_trailing_ones(shape):
+      raise ValueError("domain must have the same shape as labels. Got: {}".format(domain.shape))
+    if domain.dtype != bool:
+      domain = domain != 0
+    domain = domain.reshape(shape)
+
+  if coords is None and mask is None and domain is None and all([ policy == OPEN for (policy, _) in result ]):
+    return None
+  return _Exterior(result, coords, mask, domain)
+
+def _seeds(seeds, shape, ndim):
+  """
+  Validates the seeds argument of fill: a bool mask of 
+  the image's shape or integer coordinates of shape
+  (N, ndim). Returns: (coords padded to len(shape) axes 
+  or None, mask reshaped to shape or None)
+  """
+  if seeds is None:
+    return (None, None)
+
+  if not isinstance(seeds, (list, tuple)):
+    seeds = _as_ndarray(seeds)
+  seeds = np.asarray(seeds)
+
+  if seeds.dtype == bool:
+    if _without_trailing_ones(seeds.shape) != _without_trailing_ones(shape):
+      raise ValueError("A seed mask must have the same shape as labels. Got: {}".format(seeds.shape))
+    return (None, seeds.reshape(shape))
+
+  if seeds.ndim == 1 and seeds.size == ndim:
+    seeds = seeds[np.newaxis]
+  if seeds.size == 0:
+    seeds = seeds.reshape((0, ndim))
+  if seeds.ndim != 2 or seeds.shape[1] != ndim or not np.issubdtype(seeds.dtype, np.integer):
+    raise ValueError("seeds must be a bool mask or integer coordinates of shape (N, {}). Got: {} {}".format(ndim, seeds.dtype, seeds.shape))
+  if np.any(seeds < 0) or np.any(seeds >= np.asarray(shape[:ndim])):
+    raise ValueError("seeds must lie within the image of shape {}.".format(shape[:ndim]))
+
+  coords = np.zeros((seeds.shape[0], len(shape)), dtype=np.int64)
+  coords[:, :ndim] = seeds
+  return (coords, None)
+
+def _without_trailing_ones(shape):
+  shape = list(shape)
+  while len(shape) and shape[-1] == 1:
+    shape.pop()
+  return tuple(shape)
+
+class _VoidFilter:
+  """
+  Which voids fill keeps and, if gather_stats, the 
+  statistics of those voids collected while measuring 
+  them, on the axes of labels as passed to 
+  _flood_exterior. See filter_voids in fill_voids.hpp.
+  """
+  def __init__(self, max_size, extents, gather_stats):
+    self.max_size = max_size
+    self.extents = extents # x, y, z
+    self.gather_stats = gather_stats
+    self.voxel_counts = np.zeros((0,), dtype=np.uint64)
+    self.bounding_boxes = np.zeros((0, 2, 3), dtype=np.uint64) # min, max (inclusive)
+    self.centroids = np.zeros((0, 3), dtype=np.float64)
+
+def _void_filter(max_hole_size, max_hole_extent, return_holes, ndim):
+  """
+  Returns: None if voids are neither filtered nor 
+    listed, else a _VoidFilter with _SIZE_MAX 
+    meaning no limit.
+  """
+  if max_hole_size is None and max_hole_extent is None and not return_holes:
+    return None
+
+  if max_hole_size is None:
+    max_hole_size = _SIZE_MAX
+  elif max_hole_size < 0:
+    raise ValueError("max_hole_size must be non-negative. Got: {}".format(max_hole_size))
+
+  if max_hole_extent is None:
+    extents = [ None ] * ndim
+  elif np.isscalar(max_hole_extent):
+    extents = [ max_hole_extent ] * ndim
+  else:
+    extents = list(max_hole_extent)
+    if len(extents) != ndim:
+      raise ValueError("max_hole_extent must have one entry per axis ({}). Got: {}".format(ndim, max_hole_extent))
+
+  extents = [ _SIZE_MAX if extent is None else extent for extent in extents[:3] ]
+  if any([ extent < 0 for extent in extents ]):
+    raise ValueError("max_hole_extent must be non-negative. Got: {}".format(max_hole_extent))
+  while len(extents) < 3:
+    extents.append(_SIZE_MAX)
+
+  return _VoidFilter(
+    int(max_hole_size), [ int(extent) for extent in extents ], 
+    bool(return_holes)
+  )
+
+def _holes_statistics(void_filter, ndim):
+  """
+  Formats the void statistics like cc3d.statistics for 
+  an image of ndim dimensions, coordinates in voxels.
+  """
+  num_voids = void_filter.voxel_counts.size
+  bounding_boxes = []
+  for lo, hi in void_filter.bounding_boxes:
+    bbox = [ slice(int(lo[i]), int(hi[i]) + 1) for i in range(3) ]
+    bounding_boxes.append(tuple(bbox[:ndim] + [ slice(0, 1) ] * (ndim - 3)))
+
+  centroids = np.zeros((num_voids, ndim), dtype=np.float64)
+  centroids[:, :min(ndim, 3)] = void_filter.centroids[:, :ndim]
+
+  return {
+    "voxel_counts": void_filter.voxel_counts,
+    "bounding_boxes": bounding_boxes,
+    "centroids": centroids,
+  }
+
+def _as_2d_or_3d(labels):
+  shape = labels.shape
+
+  if labels.ndim < 2:
+    labels = labels[..., np.newaxis]
+  while labels.ndim > 3:
+    if labels.shape[-1] == 1:
+      labels = labels[..., 0]
+    else:
+      raise DimensionError("The input volume must be (effectively) a 1D, 2D or 3D image: " + str(shape))
+
+  return labels
+
+def _check_writeable(arr, name):
+  """Fails before any work is done rather than at the write."""
+  if not arr.flags.writeable:
+    raise ValueError("{} is read-only.".format(name))
+
+def _as_fortran(labels):
+  """
+  Voids are the same regardless of axis order, so a C order
+  array can be processed as its Fortran order transpose 
+  without copying or transposing it in memory.
+
+  Returns: (fortran ordered labels, transposed)
+  """
+  if labels.ndim > 1 and abs(labels.strides[0]) > abs(labels.strides[-1]):
+    return (labels.T, True)
+  return (labels, False)
+
+def _is_element_strided(arr):
+  return arr.flags.aligned and all([ s % arr.itemsize == 0 for s in arr.strides ])
+
+def _as_element_strided(arr):
+  """
+  Arrays whose strides aren't a multiple of the itemsize
+  (e.g. a field of a packed structured array) can't be 
+  addressed in elements by the C++ code, so inputs that 
+  are only read are copied.
+  """
+  if _is_element_strided(arr):
+    return arr
+  return np.copy(arr, order='K')
+
+def _check_element_strided(arr, name):
+  """Arrays that are written to can't be copied instead."""
+  if not _is_element_strided(arr):
+    raise ValueError(
+      "{} must be aligned with strides that are a multiple of its itemsize ({}). Got: {}".format(
+        name, arr.itemsize, arr.strides
+      )
+    )
+
+def _element_strides(arr):
+  """Strides of arr in elements, padded to 3D."""
+  _check_element_strided(arr, "array")
+  strides = [ s // arr.itemsize for s in arr.strides ]
+  while len(strides) < 3:
+    strides.append(0)
+  return strides
+
+def _fill_in_place(labels, mode, connectivity, void_filter=None, exterior=None, predicate=None):
+  """
+  Contiguous arrays are flooded using labels itself as
+  the working memory. Other views (e.g. a bounding box
+  of a larger volume), filtered voids, custom exteriors,
+  and foreground predicates are flooded into a 2 bit 
+  buffer and then written back through the view, which 
+  edits the parent array.
+  """
+  _check_writeable(labels, "labels")
+  _check_element_strided(labels, "labels")
+
+  if void_filter is None and exterior is None and predicate is None and (labels.flags.f_contiguous or labels.flags.c_contiguous):
+    (flooded, transposed) = _as_fortran(labels)
+    if flooded.ndim == 2:
+      (flooded, num_filled) = _fill2d(flooded, mode, connectivity)
+    else:
+      (flooded, num_filled) = _fill3d(flooded, mode, connectivity)
+    return (flooded.T if transposed else flooded, num_filled)
+
+  (flooded, buffer, num_filled, is_binary, transposed) = _flood_exterior(labels, connectivity, void_filter, exterior, predicate)
+  if num_filled > 0 or not is_binary or mode != FILLED:
+    _write_output_buffer(buffer, flooded, mode)
+
+  return (labels, num_filled)
+
+def _flood_exterior(labels, connectivity, void_filter=None, exterior=None, predicate=None):
+  """
+  Floods the exterior of labels into a 2 bit per voxel 
+  buffer without modifying or copying labels, which may
+  be any strided view. If void_filter (see _void_filter)
+  is given, voids exceeding its limits are flooded too
+  and the statistics of the rest are gathered into it.
+  exterior (see _exterior) sets where the flood starts
+  and predicate (see _predicate) which voxels of labels
+  are foreground.
+
+  Returns: (
+    labels as flooded, buffer, 
+    num_filled, is_binary, transposed
+  )
+  where transposed means a C order input was flooded 
+  as its Fortran transpose. buffer is in Fortran order
+  of labels as flooded.
+  """
+  (labels, transposed) = _as_fortran(labels)
+
+  buffer = np.zeros(((labels.size + 3) // 4,), dtype=np.uint8)
+
+  if exterior is not None and transposed:
+    exterior = exterior.transposed()
+
+  if labels.ndim == 2:
+    (num_filled, is_binary) = _flood_voids2d(labels, buffer, connectivity, exterior, predicate)
+  else:
+    (num_filled, is_binary) = _flood_voids3d(labels, buffer, connectivity, exterior, predicate)
+
+  if void_filter is not None and num_filled > 0:
+    extents = void_filter.extents
+    if transposed:
+      extents = extents[:labels.ndim][::-1] + extents[labels.ndim:]
+    num_filled = _filter_voids(labels, buffer, num_filled, void_filter, extents, connectivity)
+
+    if transposed:
+      axes = list(range(labels.ndim))[::-1] + list(range(labels.ndim, 3))
+      void_filter.bounding_boxes = void_filter.bounding_boxes[:, :, axes]
+      void_filter.centroids = void_filter.centroids[:, axes]
+
+  return (labels, buffer, num_filled, is_binary, transposed)
+
+def _filter_voids(
+  labels, cnp.ndarray[uint8_t] buffer, size_t num_voids,
+  void_filter, extents, int connectivity
+):
+  cdef uint8_t* buf = &buffer[0]
+  cdef size_t sx = labels.shape[0]
+  cdef size_t sy = labels.shape[1]
+  cdef size_t sz = labels.shape[2] if labels.ndim == 3 else 1
+  cdef size_t max_size = void_filter.max_size
+  cdef size_t ex = extents[0]
+  cdef size_t ey = extents[1]
+  cdef size_t ez = extents[2]
+  cdef size_t num_kept = 0
+
+  cdef vector[VoidStats] stats
+  cdef vector[VoidStats]* stats_ptr = &stats if void_filter.gather_stats else NULL
+
+  if labels.ndim == 2:
+    with nogil:
+      num_kept = filter_voids2d(buf, sx, sy, num_voids, max_size, ex, ey, connectivity, stats_ptr)
+  else:
+    with nogil:
+      num_kept = filter_voids3d(buf, sx, sy, sz, num_voids, max_size, ex, ey, ez, connectivity, stats_ptr)
+
+  cdef size_t num_stats = stats.size()
+  cdef cnp.ndarray[uint64_t] voxel_counts = np.zeros((num_stats,), dtype=np.uint64)
+  cdef cnp.ndarray[uint64_t, ndim=3] bounding_boxes = np.zeros((num_stats, 2, 3), dtype=np.uint64)
+  cdef cnp.ndarray[double, ndim=2] centroids = np.zeros((num_stats, 3), dtype=np.float64)
+
+  cdef size_t i = 0
+  cdef int j = 0
+  for i in range(num_stats):
+    voxel_counts[i] = stats[i].voxels
+    for j in range(3):
+      bounding_boxes[i, 0, j] = stats[i].min_corner[j]
+      bounding_boxes[i, 1, j] = stats[i].max_corner[j]
+      centroids[i, j] = stats[i].coord_sum[j] / <double>stats[i].voxels
+
+  void_filter.voxel_counts = voxel_counts
+  void_filter.bounding_boxes = bounding_boxes
+  void_filter.centroids = centroids
+
+  return num_kept
+
+def _fill_lazy(labels, mode, out_dtype, connectivity, void_filter=None, exterior=None, predicate=None):
+  """
+  Floods the exterior into a 2 bit per voxel buffer before
+  deciding whether an output image is needed at all. Most
+  objects have no voids, and if the input is already 0/1 
+  it is returned as a read-only view instead of a copy.
+  Likewise, no voids means an all zero holes image.
+  The output is written as out_dtype directly.
+  """
+  (labels, buffer, num_filled, is_binary, transposed) = _flood_exterior(labels, connectivity, void_filter, exterior, predicate)
 
-def _fill3d(cnp.ndarray[NUMBER, cast=True, ndim=3] labels, in_place=False):
-  if not in_place:
-    labels = np.copy(labels, order='F')
+  if num_filled == 0 and mode == HOLES:
+    labels = np.zeros(labels.shape, dtype=out_dtype, order='F')
+  elif num_filled > 0 or not is_binary or mode != FILLED or labels.dtype != out_dtype:
+    output = np.empty(labels.shape, dtype=out_dtype, order='F')
+    _write_output_buffer(buffer, output, mode)
+    labels = output
   else:
-    labels = fastremap.asfortranarray(labels)
+    labels = labels.view()
+    labels.setflags(write=False)
+
+  if transposed:
+    labels = labels.T
+
+  return (labels, num_filled)
+
+def _fill_value(labels, fill_value, in_place, connectivity, void_filter=None, exterior=None, predicate=None):
+  """
+  Writes fill_value into the voids of labels and leaves the
+  foreground alone. If in_place, labels is edited directly,
+  even if it is a view. Otherwise, a copy is only made when
+  there is something to fill.
+  """
+  if in_place:
+    _check_writeable(labels, "labels")
+    _check_element_strided(labels, "labels")
+
+  (flooded, buffer, num_filled, _, transposed) = _flood_exterior(labels, connectivity, void_filter, exterior, predicate)
 
+  if num_filled == 0:
+    if not in_place:
+      flooded = flooded.view()
+      flooded.setflags(write=False)
+  else:
+    if not in_place:
+      flooded = np.copy(flooded, order='F')
+    _write_fill_value_buffer(buffer, flooded, fill_value)
+
+  if transposed:
+    flooded = flooded.T
+
+  return (flooded, num_filled)
+
+def _write_fill_value_buffer(cnp.ndarray[uint8_t] buffer, out, value):
+  # 2D images are written as a single z slice
+  if out.ndim == 2:
+    out = out[:, :, np.newaxis]
+  return _write_fill_value_buffer3d(buffer, out, value)
+
+@cython.warn.maybe_uninitialized(False)
+def _write_fill_value_buffer3d(cnp.ndarray[uint8_t] buffer, cnp.ndarray[NUMBER, cast=True, ndim=3] out, value):
+  dtype = out.dtype
+  value = np.asarray(value, dtype=dtype)
+
+  cdef uint8_t* buf = &buffer[0]
+  cdef void* data = <void*>&out[0,0,0]
+  cdef void* value_ptr = cnp.PyArray_DATA(value)
+  cdef size_t sx = out.shape[0]
+  cdef size_t sy = out.shape[1]
+  cdef size_t sz = out.shape[2]
+  cdef int64_t csx, csy, csz
+  (csx, csy, csz) = _element_strides(out)
+
+  if dtype in (np.uint8, np.int8, bool):
+    with nogil:
+      write_fill_value_buffer[uint8_t](buf, <uint8_t*>data, sx, sy, sz, csx, csy, csz, (<uint8_t*>value_ptr)[0])
+  elif dtype in (np.uint16, np.int16):
+    with nogil:
+      write_fill_value_buffer[uint16_t](buf, <uint16_t*>data, sx, sy, sz, csx, csy, csz, (<uint16_t*>value_ptr)[0])
+  elif dtype in (np.uint32, np.int32):
+    with nogil:
+      write_fill_value_buffer[uint32_t](buf, <uint32_t*>data, sx, sy, sz, csx, csy, csz, (<uint32_t*>value_ptr)[0])
+  elif dtype in (np.uint64, np.int64):
+    with nogil:
+      write_fill_value_buffer[uint64_t](buf, <uint64_t*>data, sx, sy, sz, csx, csy, csz, (<uint64_t*>value_ptr)[0])
+  elif dtype == np.float32:
+    with nogil:
+      write_fill_value_buffer[float](buf, <float*>data, sx, sy, sz, csx, csy, csz, (<float*>value_ptr)[0])
+  elif dtype == np.float64:
+    with nogil:
+      write_fill_value_buffer[double](buf, <double*>data, sx, sy, sz, csx, csy, csz, (<double*>value_ptr)[0])
+  else:
+    raise TypeError("Type {} not supported.".format(dtype))
+
+def _fill_out(labels, mode, out, connectivity, void_filter=None, exterior=None, predicate=None):
+  """
+  Fills labels into a caller provided out array, which 
+  can be any writable strided view. The result is written
+  directly into it without an intermediate image.
+  """
+  (_, buffer, num_filled, _, transposed) = _flood_exterior(labels, connectivity, void_filter, exterior, predicate)
+
+  if out.dtype == bool:
+    out = out.view(np.uint8)
+
+  _write_output_buffer(buffer, out.T if transposed else out, mode)
+  return num_filled
+
+def _fill_packed(labels, OutputMode mode, int connectivity, void_filter=None, exterior=None, predicate=None):
+  """
+  Fills labels and returns the result packed 8 voxels 
+  per byte in Fortran order of labels' shape, the same
+  as np.packbits(result.ravel(order='F')).
+  """
+  (flooded, buffer, num_filled, _, transposed) = _flood_exterior(labels, connectivity, void_filter, exterior, predicate)
+
+  cdef cnp.ndarray[uint8_t] packed = np.empty(((flooded.size + 7) // 8,), dtype=np.uint8)
+  cdef cnp.ndarray[uint8_t] buf = buffer
+  cdef uint8_t* buf_ptr = &buf[0]
+  cdef uint8_t* packed_ptr = &packed[0]
+
+  shape = list(flooded.shape)
+  strides = [ 1, shape[0], shape[0] * shape[1] ][:len(shape)]
+  if transposed:
+    shape = shape[::-1]
+    strides = strides[::-1]
+  while len(shape) < 3:
+    shape.append(1)
+    strides.append(0)
+
+  cdef size_t sx, sy, sz, csx, csy, csz
+  (sx, sy, sz) = shape
+  (csx, csy, csz) = strides
+
+  with nogil:
+    write_output_packed_buffer(
+      buf_ptr, packed_ptr, 
+      sx, sy, sz, 
+      csx, csy, csz,
+      mode
+    )
+
+  return (packed, num_filled)
+
+@cython.warn.maybe_uninitialized(False)
+def _flood_voids3d(cnp.ndarray[NUMBER, cast=True, ndim=3] labels, cnp.ndarray[uint8_t] buffer, int connectivity, exterior=None, predicate=None):
   dtype = labels.dtype
 
+  cdef uint8_t* buf = &buffer[0]
+  cdef void* data = <void*>&labels[0,0,0]
+  cdef size_t sx = labels.shape[0]
+  cdef size_t sy = labels.shape[1]
+  cdef size_t sz = labels.shape[2]
+  cdef int64_t csx, csy, csz
+  (csx, csy, csz) = _element_strides(labels)
+
   cdef size_t num_filled = 0
+  cdef native_bool is_binary = False
+
+  cdef Boundaries bounds
+  cdef Boundaries* bounds_ptr = NULL
+  if exterior is not None:
+    _set_boundaries(&bounds, exterior, (sx, sy, sz))
+    bounds_ptr = &bounds
+
+  cdef Foreground fg
+  cdef Foreground* fg_ptr = NULL
+  if predicate is not None:
+    (kind, values) = predicate
+    fg.kind = kind
+    fg.values = cnp.PyArray_DATA(values)
+    fg.num_values = values.size
+    fg_ptr = &fg
 
   if dtype in (np.uint8, np.int8, bool):
-    num_filled = binary_fill_holes3d[uint8_t](<uint8_t*>&labels[0,0,0], labels.shape[0], labels.shape[1], labels.shape[2])
+    with nogil:
+      num_filled = flood_voids3d[uint8_t](<uint8_t*>data, buf, sx, sy, sz, csx, csy, csz, is_binary, connectivity, bounds_ptr, fg_ptr)
   elif dtype in (np.uint16, np.int16):
-    num_filled = binary_fill_holes3d[uint16_t](<uint16_t*>&labels[0,0,0], labels.shape[0], labels.shape[1], labels.shape[2])
+    with nogil:
+      num_filled = flood_voids3d[uint16_t](<uint16_t*>data, buf, sx, sy, sz, csx, csy, csz, is_binary, connectivity, bounds_ptr, fg_ptr)
   elif dtype in (np.uint32, np.int32):
-    num_filled = binary_fill_holes3d[uint32_t](<uint32_t*>&labels[0,0,0], labels.shape[0], labels.shape[1], labels.shape[2])
+    with nogil:
+      num_filled = flood_voids3d[uint32_t](<uint32_t*>data, buf, sx, sy, sz, csx, csy, csz, is_binary, connectivity, bounds_ptr, fg_ptr)
   elif dtype in (np.uint64, np.int64):
-    num_filled = binary_fill_holes3d[uint64_t](<uint64_t*>&labels[0,0,0], labels.shape[0], labels.shape[1], labels.shape[2])
+    with nogil:
+      num_filled = flood_voids3d[uint64_t](<uint64_t*>data, buf, sx, sy, sz, csx, csy, csz, is_binary, connectivity, bounds_ptr, fg_ptr)
   elif dtype == np.float32:
-    num_filled = binary_fill_holes3d[float](<float*>&labels[0,0,0], labels.shape[0], labels.shape[1], labels.shape[2])
+    with nogil:
+      num_filled = flood_voids3d[float](<float*>data, buf, sx, sy, sz, csx, csy, csz, is_binary, connectivity, bounds_ptr, fg_ptr)
   elif dtype == np.float64:
-    num_filled = binary_fill_holes3d[double](<double*>&labels[0,0,0], labels.shape[0], labels.shape[1], labels.shape[2])
+    with nogil:
+      num_filled = flood_voids3d[double](<double*>data, buf, sx, sy, sz, csx, csy, csz, is_binary, connectivity, bounds_ptr, fg_ptr)
   else:
     raise TypeError("Type {} not supported.".format(dtype))
 
-  return (labels, num_filled)
+  return (num_filled, is_binary)
+
+@cython.warn.maybe_uninitialized(False)
+def _flood_voids2d(cnp.ndarray[NUMBER, cast=True, ndim=2] labels, cnp.ndarray[uint8_t] buffer, int connectivity, exterior=None, predicate=None):
+  dtype = labels.dtype
 
-def _fill2d(cnp.ndarray[NUMBER, cast=True, ndim=2] labels, in_place=False):
-  if not in_place:
-    labels = np.copy(labels, order='F')
+  cdef uint8_t* buf = &buffer[0]
+  cdef void* data = <void*>&labels[0,0]
+  cdef size_t sx = labels.shape[0]
+  cdef size_t sy = labels.shape[1]
+  cdef int64_t csx, csy
+  (csx, csy) = _element_strides(labels)[:2]
+
+  cdef size_t num_filled = 0
+  cdef native_bool is_binary = False
+
+  cdef Boundaries bounds
+  cdef Boundaries* bounds_ptr = NULL
+  if exterior is not None:
+    _set_boundaries(&bounds, exterior, (sx, sy))
+    bounds_ptr = &bounds
+
+  cdef Foreground fg
+  cdef Foreground* fg_ptr = NULL
+  if predicate is not None:
+    (kind, values) = predicate
+    fg.kind = kind
+    fg.values = cnp.PyArray_DATA(values)
+    fg.num_values = values.size
+    fg_ptr = &fg
+
+  if dtype in (np.uint8, np.int8, bool):
+    with nogil:
+      num_filled = flood_voids2d[uint8_t](<uint8_t*>data, buf, sx, sy, csx, csy, is_binary, connectivity, bounds_ptr, fg_ptr)
+  elif dtype in (np.uint16, np.int16):
+    with nogil:
+      num_filled = flood_voids2d[uint16_t](<uint16_t*>data, buf, sx, sy, csx, csy, is_binary, connectivity, bounds_ptr, fg_ptr)
+  elif dtype in (np.uint32, np.int32):
+    with nogil:
+      num_filled = flood_voids2d[uint32_t](<uint32_t*>data, buf, sx, sy, csx, csy, is_binary, connectivity, bounds_ptr, fg_ptr)
+  elif dtype in (np.uint64, np.int64):
+    with nogil:
+      num_filled = flood_voids2d[uint64_t](<uint64_t*>data, buf, sx, sy, csx, csy, is_binary, connectivity, bounds_ptr, fg_ptr)
+  elif dtype == np.float32:
+    with nogil:
+      num_filled = flood_voids2d[float](<float*>data, buf, sx, sy, csx, csy, is_binary, connectivity, bounds_ptr, fg_ptr)
+  elif dtype == np.float64:
+    with nogil:
+      num_filled = flood_voids2d[double](<double*>data, buf, sx, sy, csx, csy, is_binary, connectivity, bounds_ptr, fg_ptr)
   else:
-    labels = fastremap.asfortranarray(labels)
+    raise TypeError("Type {} not supported.".format(dtype))
+
+  return (num_filled, is_binary)
+
+cdef _set_boundaries(Boundaries* bounds, exterior, shape):
+  """
+  Fills in bounds from an _Exterior (see _exterior) for 
+  an image of shape. The arrays bounds points into are
+  stored on exterior, which keeps them alive while the
+  caller holds it.
+  """
+  cdef int face = 0
+  for face in range(6):
+    bounds.faces[face] = OPEN
+    bounds.seeds[face] = NULL
+  for face, (policy, face_seeds) in enumerate(exterior.faces):
+    bounds.faces[face] = policy
+    if face_seeds is not None:
+      bounds.seeds[face] = <const uint8_t*>cnp.PyArray_DATA(face_seeds)
+
+  bounds.points = NULL
+  bounds.num_points = 0
+  points = None
+  if exterior.coords is not None and len(exterior.coords):
+    points = np.ravel_multi_index(
+      tuple(exterior.coords[:, :len(shape)].T), shape, order='F'
+    ).astype(np.uintp)
+    bounds.points = <const size_t*>cnp.PyArray_DATA(points)
+    bounds.num_points = points.size
+
+  bounds.mask = NULL
+  mask = None
+  if exterior.mask is not None:
+    mask = np.asfortranarray(exterior.mask).view(np.uint8)
+    bounds.mask = <const uint8_t*>cnp.PyArray_DATA(mask)
+
+  bounds.domain = NULL
+  domain = None
+  if exterior.domain is not None:
+    domain = np.asfortranarray(exterior.domain).view(np.uint8)
+    bounds.domain = <const uint8_t*>cnp.PyArray_DATA(domain)
+
+  exterior.arrays = (points, mask, domain)
+
+def _write_output_buffer(cnp.ndarray[uint8_t] buffer, out, OutputMode mode):
+  # 2D images are written as a single z slice
+  if out.ndim == 2:
+    out = out[:, :, np.newaxis]
+  return _write_output_buffer3d(buffer, out, mode)
+
+@cython.warn.maybe_uninitialized(False)
+def _write_output_buffer3d(cnp.ndarray[uint8_t] buffer, cnp.ndarray[NUMBER, cast=True, ndim=3] out, OutputMode mode):
+  dtype = out.dtype
 
+  cdef uint8_t* buf = &buffer[0]
+  cdef void* data = <void*>&out[0,0,0]
+  cdef size_t sx = out.shape[0]
+  cdef size_t sy = out.shape[1]
+  cdef size_t sz = out.shape[2]
+  cdef int64_t csx, csy, csz
+  (csx, csy, csz) = _element_strides(out)
+
+  if dtype in (np.uint8, np.int8, bool):
+    with nogil:
+      write_output_buffer[uint8_t](buf, <uint8_t*>data, sx, sy, sz, csx, csy, csz, mode)
+  elif dtype in (np.uint16, np.int16):
+    with nogil:
+      write_output_buffer[uint16_t](buf, <uint16_t*>data, sx, sy, sz, csx, csy, csz, mode)
+  elif dtype in (np.uint32, np.int32):
+    with nogil:
+      write_output_buffer[uint32_t](buf, <uint32_t*>data, sx, sy, sz, csx, csy, csz, mode)
+  elif dtype in (np.uint64, np.int64):
+    with nogil:
+      write_output_buffer[uint64_t](buf, <uint64_t*>data, sx, sy, sz, csx, csy, csz, mode)
+  elif dtype == np.float32:
+    with nogil:
+      write_output_buffer[float](buf, <float*>data, sx, sy, sz, csx, csy, csz, mode)
+  elif dtype == np.float64:
+    with nogil:
+      write_output_buffer[double](buf, <double*>data, sx, sy, sz, csx, csy, csz, mode)
+  else:
+    raise TypeError("Type {} not supported.".format(dtype))
+
+@cython.warn.maybe_uninitialized(False)
+def _fill3d(cnp.ndarray[NUMBER, cast=True, ndim=3] labels, OutputMode mode, int connectivity):
   dtype = labels.dtype
 
+  cdef void* data = <void*>&labels[0,0,0]
+  cdef size_t sx = labels.shape[0]
+  cdef size_t sy = labels.shape[1]
+  cdef size_t sz = labels.shape[2]
+
   cdef size_t num_filled = 0
 
   if dtype in (np.uint8, np.int8, bool):
-    num_filled = binary_fill_holes2d[uint8_t](<uint8_t*>&labels[0,0], labels.shape[0], labels.shape[1])
+    with nogil:
+      num_filled = binary_fill_holes3d[uint8_t](<uint8_t*>data, sx, sy, sz, mode, connectivity)
   elif dtype in (np.uint16, np.int16):
-    num_filled = binary_fill_holes2d[uint16_t](<uint16_t*>&labels[0,0], labels.shape[0], labels.shape[1])
+    with nogil:
+      num_filled = binary_fill_holes3d[uint16_t](<uint16_t*>data, sx, sy, sz, mode, connectivity)
   elif dtype in (np.uint32, np.int32):
-    num_filled = binary_fill_holes2d[uint32_t](<uint32_t*>&labels[0,0], labels.shape[0], labels.shape[1])
+    with nogil:
+      num_filled = binary_fill_holes3d[uint32_t](<uint32_t*>data, sx, sy, sz, mode, connectivity)
   elif dtype in (np.uint64, np.int64):
-    num_filled = binary_fill_holes2d[uint64_t](<uint64_t*>&labels[0,0], labels.shape[0], labels.shape[1])
+    with nogil:
+      num_filled = binary_fill_holes3d[uint64_t](<uint64_t*>data, sx, sy, sz, mode, connectivity)
   elif dtype == np.float32:
-    num_filled = binary_fill_holes2d[float](<float*>&labels[0,0], labels.shape[0], labels.shape[1])
+    with nogil:
+      num_filled = binary_fill_holes3d[float](<float*>data, sx, sy, sz, mode, connectivity)
   elif dtype == np.float64:
-    num_filled = binary_fill_holes2d[double](<double*>&labels[0,0], labels.shape[0], labels.shape[1])
+    with nogil:
+      num_filled = binary_fill_holes3d[double](<double*>data, sx, sy, sz, mode, connectivity)
   else:
     raise TypeError("Type {} not supported.".format(dtype))
 
   return (labels, num_filled)
 
+@cython.warn.maybe_uninitialized(False)
+def _fill2d(cnp.ndarray[NUMBER, cast=True, ndim=2] labels, OutputMode mode, int connectivity):
+  dtype = labels.dtype
+
+  cdef void* data = <void*>&labels[0,0]
+  cdef size_t sx = labels.shape[0]
+  cdef size_t sy = labels.shape[1]
+
+  cdef size_t num_filled = 0
+
+  if dtype in (np.uint8, np.int8, bool):
+    with nogil:
+      num_filled = binary_fill_holes2d[uint8_t](<uint8_t*>data, sx, sy, mode, connectivity)
+  elif dtype in (np.uint16, np.int16):
+    with nogil:
+      num_filled = binary_fill_holes2d[uint16_t](<uint16_t*>data, sx, sy, mode, connectivity)
+  elif dtype in (np.uint32, np.int32):
+    with nogil:
+      num_filled = binary_fill_holes2d[uint32_t](<uint32_t*>data, sx, sy, mode, connectivity)
+  elif dtype in (np.uint64, np.int64):
+    with nogil:
+      num_filled = binary_fill_holes2d[uint64_t](<uint64_t*>data, sx, sy, mode, connectivity)
+  elif dtype == np.float32:
+    with nogil:
+      num_filled = binary_fill_holes2d[float](<float*>data, sx, sy, mode, connectivity)
+  elif dtype == np.float64:
+    with nogil:
+      num_filled = binary_fill_holes2d[double](<double*>data, sx, sy, mode, connectivity)
+  else:
+    raise TypeError("Type {} not supported.".format(dtype))
+
+  return (labels, num_filled)
+
+@cython.warn.maybe_uninitialized(False)
+def _fill_slices(
+  cnp.ndarray[NUMBER, cast=True, ndim=3] labels, 
+  cnp.ndarray[NUMBER, cast=True, ndim=3] out,
+  int axis, cnp.ndarray[size_t] counts, 
+  size_t threads, OutputMode mode, int connectivity
+):
+  dtype = labels.dtype
+
+  cdef void* data = <void*>&labels[0,0,0]
+  cdef void* out_data = <void*>&out[0,0,0]
+  cdef size_t* cts = &counts[0]
+  cdef size_t sx = labels.shape[0]
+  cdef size_t sy = labels.shape[1]
+  cdef size_t sz = labels.shape[2]
+  cdef int64_t csx, csy, csz, osx, osy, osz
+  (csx, csy, csz) = _element_strides(labels)
+  (osx, osy, osz) = _element_strides(out)
+  cdef int ax = axis
+  cdef size_t num_threads = threads
+
+  if dtype in (np.uint8, np.int8, bool):
+    with nogil:
+      binary_fill_holes_slices[uint8_t,uint8_t](<uint8_t*>data, <uint8_t*>out_data, sx, sy, sz, csx, csy, csz, osx, osy, osz, ax, &cts[0], num_threads, mode, connectivity)
+  elif dtype in (np.uint16, np.int16):
+    with nogil:
+      binary_fill_holes_slices[uint16_t,uint16_t](<uint16_t*>data, <uint16_t*>out_data, sx, sy, sz, csx, csy, csz, osx, osy, osz, ax, &cts[0], num_threads, mode, connectivity)
+  elif dtype in (np.uint32, np.int32):
+    with nogil:
+      binary_fill_holes_slices[uint32_t,uint32_t](<uint32_t*>data, <uint32_t*>out_data, sx, sy, sz, csx, csy, csz, osx, osy, osz, ax, &cts[0], num_threads, mode, connectivity)
+  elif dtype in (np.uint64, np.int64):
+    with nogil:
+      binary_fill_holes_slices[uint64_t,uint64_t](<uint64_t*>data, <uint64_t*>out_data, sx, sy, sz, csx, csy, csz, osx, osy, osz, ax, &cts[0], num_threads, mode, connectivity)
+  elif dtype == np.float32:
+    with nogil:
+      binary_fill_holes_slices[float,float](<float*>data, <float*>out_data, sx, sy, sz, csx, csy, csz, osx, osy, osz, ax, &cts[0], num_threads, mode, connectivity)
+  elif dtype == np.float64:
+    with nogil:
+      binary_fill_holes_slices[double,double](<double*>data, <double*>out_data, sx, sy, sz, csx, csy, csz, osx, osy, osz, ax, &cts[0], num_threads, mode, connectivity)
+  else:
+    raise TypeError("Type {} not supported.".format(dtype))
+
+@cython.warn.maybe_uninitialized(False)
+def _fill_labels3d(cnp.ndarray[NUMBER, cast=True, ndim=3] labels, int connectivity):
+  dtype = labels.dtype
+
+  cdef void* data = <void*>&labels[0,0,0]
+  cdef size_t sx = labels.shape[0]
+  cdef size_t sy = labels.shape[1]
+  cdef size_t sz = labels.shape[2]
+  cdef int64_t csx, csy, csz
+  (csx, csy, csz) = _element_strides(labels)
+
+  cdef size_t num_filled = 0
+
+  if dtype in (np.uint8, np.int8, bool):
+    with nogil:
+      num_filled = fill_labels3d[uint8_t](<uint8_t*>data, sx, sy, sz, csx, csy, csz, connectivity)
+  elif dtype in (np.uint16, np.int16):
+    with nogil:
+      num_filled = fill_labels3d[uint16_t](<uint16_t*>data, sx, sy, sz, csx, csy, csz, connectivity)
+  elif dtype in (np.uint32, np.int32):
+    with nogil:
+      num_filled = fill_labels3d[uint32_t](<uint32_t*>data, sx, sy, sz, csx, csy, csz, connectivity)
+  elif dtype in (np.uint64, np.int64):
+    with nogil:
+      num_filled = fill_labels3d[uint64_t](<uint64_t*>data, sx, sy, sz, csx, csy, csz, connectivity)
+  elif dtype == np.float32:
+    with nogil:
+      num_filled = fill_labels3d[float](<float*>data, sx, sy, sz, csx, csy, csz, connectivity)
+  elif dtype == np.float64:
+    with nogil:
+      num_filled = fill_labels3d[double](<double*>data, sx, sy, sz, csx, csy, csz, connectivity)
+  else:
+    raise TypeError("Type {} not supported.".format(dtype))
+
+  return num_filled
+
+@cython.warn.maybe_uninitialized(False)
+def _fill_labels2d(cnp.ndarray[NUMBER, cast=True, ndim=2] labels, int connectivity):
+  dtype = labels.dtype
+
+  cdef void* data = <void*>&labels[0,0]
+  cdef size_t sx = labels.shape[0]
+  cdef size_t sy = labels.shape[1]
+  cdef int64_t csx, csy
+  (csx, csy) = _element_strides(labels)[:2]
+
+  cdef size_t num_filled = 0
+
+  if dtype in (np.uint8, np.int8, bool):
+    with nogil:
+      num_filled = fill_labels2d[uint8_t](<uint8_t*>data, sx, sy, csx, csy, connectivity)
+  elif dtype in (np.uint16, np.int16):
+    with nogil:
+      num_filled = fill_labels2d[uint16_t](<uint16_t*>data, sx, sy, csx, csy, connectivity)
+  elif dtype in (np.uint32, np.int32):
+    with nogil:
+      num_filled = fill_labels2d[uint32_t](<uint32_t*>data, sx, sy, csx, csy, connectivity)
+  elif dtype in (np.uint64, np.int64):
+    with nogil:
+      num_filled = fill_labels2d[uint64_t](<uint64_t*>data, sx, sy, csx, csy, connectivity)
+  elif dtype == np.float32:
+    with nogil:
+      num_filled = fill_labels2d[float](<float*>data, sx, sy, csx, csy, connectivity)
+  elif dtype == np.float64:
+    with nogil:
+      num_filled = fill_labels2d[double](<double*>data, sx, sy, csx, csy, connectivity)
+  else:
+    raise TypeError("Type {} not supported.".format(dtype))
+
+  return num_filled
+
+@cython.warn.maybe_uninitialized(False)
+def _fill_2p5d(
+  cnp.ndarray[NUMBER, cast=True, ndim=3] labels, 
+  cnp.ndarray[NUMBER, cast=True, ndim=3] out,
+  Combine mode, size_t threads
+):
+  dtype = labels.dtype
+
+  cdef void* data = <void*>&labels[0,0,0]
+  cdef void* out_data = <void*>&out[0,0,0]
+  cdef size_t sx = labels.shape[0]
+  cdef size_t sy = labels.shape[1]
+  cdef size_t sz = labels.shape[2]
+  cdef int64_t csx, csy, csz
+  (csx, csy, csz) = _element_strides(labels)
+  cdef size_t num_threads = threads
+
+  cdef size_t num_filled = 0
+
+  if dtype in (np.uint8, np.int8, bool):
+    with nogil:
+      num_filled = binary_fill_holes_2p5d[uint8_t,uint8_t](<uint8_t*>data, <uint8_t*>out_data, sx, sy, sz, csx, csy, csz, mode, num_threads)
+  elif dtype in (np.uint16, np.int16):
+    with nogil:
+      num_filled = binary_fill_holes_2p5d[uint16_t,uint16_t](<uint16_t*>data, <uint16_t*>out_data, sx, sy, sz, csx, csy, csz, mode, num_threads)
+  elif dtype in (np.uint32, np.int32):
+    with nogil:
+      num_filled = binary_fill_holes_2p5d[uint32_t,uint32_t](<uint32_t*>data, <uint32_t*>out_data, sx, sy, sz, csx, csy, csz, mode, num_threads)
+  elif dtype in (np.uint64, np.int64):
+    with nogil:
+      num_filled = binary_fill_holes_2p5d[uint64_t,uint64_t](<uint64_t*>data, <uint64_t*>out_data, sx, sy, sz, csx, csy, csz, mode, num_threads)
+  elif dtype == np.float32:
+    with nogil:
+      num_filled = binary_fill_holes_2p5d[float,float](<float*>data, <float*>out_data, sx, sy, sz, csx, csy, csz, mode, num_threads)
+  elif dtype == np.float64:
+    with nogil:
+      num_filled = binary_fill_holes_2p5d[double,double](<double*>data, <double*>out_data, sx, sy, sz, csx, csy, csz, mode, num_threads)
+  else:
+    raise TypeError("Type {} not supported.".format(dtype))
+
+  return num_filled
+
+def _fill_batch_dispatch(
+  cnp.ndarray labels, cnp.ndarray out, 
+  spatial_axes, batch_axes, cnp.ndarray[size_t] counts, 
+  size_t threads, OutputMode mode, int connectivity
+):
+  dtype = labels.dtype
+
+  shape = [ labels.shape[axis] for axis in spatial_axes ] + [1, 1]
+  strides = [ labels.strides[axis] // labels.itemsize for axis in spatial_axes ] + [0, 0]
+  out_strides = [ out.strides[axis] // out.itemsize for axis in spatial_axes ] + [0, 0]
+
+  cdef cnp.ndarray[int64_t] offsets = _batch_offsets(labels, batch_axes)
+  cdef cnp.ndarray[int64_t] out_offsets = _batch_offsets(out, batch_axes)
+
+  cdef void* data = cnp.PyArray_DATA(labels)
+  cdef void* out_data = cnp.PyArray_DATA(out)
+  cdef int64_t* offs = &offsets[0]
+  cdef int64_t* out_offs = &out_offsets[0]
+  cdef size_t* cts = &counts[0]
+  cdef size_t num_volumes = counts.size
+  cdef size_t sx = shape[0]
+  cdef size_t sy = shape[1]
+  cdef size_t sz = shape[2]
+  cdef int ndim = max(len(spatial_axes), 2)
+  cdef int64_t csx = strides[0]
+  cdef int64_t csy = strides[1]
+  cdef int64_t csz = strides[2]
+  cdef int64_t osx = out_strides[0]
+  cdef int64_t osy = out_strides[1]
+  cdef int64_t osz = out_strides[2]
+  cdef size_t num_threads = threads
+
+  if dtype in (np.uint8, np.int8, bool):
+    with nogil:
+      binary_fill_holes_batch[uint8_t,uint8_t](<uint8_t*>data, <uint8_t*>out_data, sx, sy, sz, ndim, csx, csy, csz, osx, osy, osz, &offs[0], &out_offs[0], num_volumes, &cts[0], num_threads, mode, connectivity)
+  elif dtype in (np.uint16, np.int16):
+    with nogil:
+      binary_fill_holes_batch[uint16_t,uint16_t](<uint16_t*>data, <uint16_t*>out_data, sx, sy, sz, ndim, csx, csy, csz, osx, osy, osz, &offs[0], &out_offs[0], num_volumes, &cts[0], num_threads, mode, connectivity)
+  elif dtype in (np.uint32, np.int32):
+    with nogil:
+      binary_fill_holes_batch[uint32_t,uint32_t](<uint32_t*>data, <uint32_t*>out_data, sx, sy, sz, ndim, csx, csy, csz, osx, osy, osz, &offs[0], &out_offs[0], num_volumes, &cts[0], num_threads, mode, connectivity)
+  elif dtype in (np.uint64, np.int64):
+    with nogil:
+      binary_fill_holes_batch[uint64_t,uint64_t](<uint64_t*>data, <uint64_t*>out_data, sx, sy, sz, ndim, csx, csy, csz, osx, osy, osz, &offs[0], &out_offs[0], num_volumes, &cts[0], num_threads, mode, connectivity)
+  elif dtype == np.float32:
+    with nogil:
+      binary_fill_holes_batch[float,float](<float*>data, <float*>out_data, sx, sy, sz, ndim, csx, csy, csz, osx, osy, osz, &offs[0], &out_offs[0], num_volumes, &cts[0], num_threads, mode, connectivity)
+  elif dtype == np.float64:
+    with nogil:
+      binary_fill_holes_batch[double,double](<double*>data, <double*>out_data, sx, sy, sz, ndim, csx, csy, csz, osx, osy, osz, &offs[0], &out_offs[0], num_volumes, &cts[0], num_threads, mode, connectivity)
+  else:
+    raise TypeError("Type {} not supported.".format(dtype))
+
 def void_shard():
   """??? what's this ???"""
   print("Play Starcraft 2!")
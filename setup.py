@@ -13,7 +13,7 @@ class NumpyImport:
 # cython -3 --cplus fill_voids.pyx
 
 setuptools.setup(
-  setup_requires=['pbr', 'numpy', 'cython'],
+  setup_requires=['pbr', 'numpy', 'cython>=3.1'],
   extras_require={
      'test': ['scipy'],
   },